@@ -8,14 +8,18 @@ CONFIG += c++17
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
+include(ndfa.pri)
+
 SOURCES += \
+    fatablemodel.cpp \
     main.cpp \
     mainwindow.cpp \
-    ndfa.cpp
+    ndfaworker.cpp
 
 HEADERS += \
+    fatablemodel.h \
     mainwindow.h \
-    ndfa.h
+    ndfaworker.h
 
 FORMS += \
     mainwindow.ui
@@ -0,0 +1,12 @@
+# 转换流程各阶段的基准测试，不依赖QtWidgets
+QT       = core
+
+CONFIG += c++17 console release
+CONFIG -= app_bundle
+
+TARGET = r2lexer-bench
+
+include(../ndfa.pri)
+
+SOURCES += \
+    main.cpp
@@ -0,0 +1,373 @@
+/****************************************************
+ * @Copyright © 2021-2023 Lyuyk. All rights reserved.
+ *
+ * @FileName: bench/main.cpp
+ * @Brief: 转换流程各阶段的基准测试
+ * @Module Function: 以规模递增的合成正则表达式族（关键字长选择、嵌套闭包、
+ *                   (a|b)*a(a|b)^n 状态爆炸）与MiniC词法规则为输入，
+ *                   分别计时 reg2NFA、epsilon闭包、NFA2DFA、DFA2mDFA、mDFA2Lexer，
+ *                   并输出各阶段状态数与峰值内存；可选Thompson与followpos两种DFA构造方式对比
+ *
+ * @Current Version: 1.0
+ * @Author: Lyuyk
+ * @Modifier: Lyuyk
+ * @Finished Date: 2026/10/16
+ *
+ * @Version History: 1.0 current version
+ *
+ ****************************************************/
+#include "ndfa.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+
+#include <functional>
+
+//一个测试用例：单条正则表达式（第二行关键字）或多规则文件的各行
+struct BenchCase
+{
+    QString family;//所属族
+    int size;//规模参数
+    QStringList lines;//与正则表达式文件格式相同
+};
+
+//一个用例各阶段的最短耗时（纳秒）与规模
+struct BenchResult
+{
+    qint64 reg2NFA=-1;
+    qint64 closure=-1;
+    qint64 NFA2DFA=-1;
+    qint64 DFA2mDFA=-1;
+    qint64 mDFA2Lexer=-1;
+    NDFA::PhaseStats stats;
+    qint64 peakKiB=-1;//峰值常驻内存，不支持的平台为-1
+};
+
+static void quietMessageHandler(QtMsgType type, const QMessageLogContext &, const QString &msg)
+{
+    if(type==QtDebugMsg || type==QtInfoMsg)
+        return;
+    QTextStream(stderr)<<msg<<"\n";
+}
+
+/**
+ * @brief readProcStatus
+ * @param key
+ * @return /proc/self/status 中key一项的KiB数，不支持的平台返回-1
+ */
+static qint64 readProcStatus(const QByteArray &key)
+{
+#ifdef Q_OS_LINUX
+    QFile status("/proc/self/status");
+    if(!status.open(QIODevice::ReadOnly|QIODevice::Text))
+        return -1;
+    const QList<QByteArray> lines=status.readAll().split('\n');
+    for(const auto &line: lines)
+        if(line.startsWith(key+":"))
+            return line.mid(key.size()+1).trimmed().split(' ').value(0).toLongLong();
+#else
+    Q_UNUSED(key);
+#endif
+    return -1;
+}
+
+/**
+ * @brief resetPeakMemory
+ * 将峰值常驻内存复位为当前值（Linux: 向clear_refs写5），使每个用例单独统计峰值
+ */
+static void resetPeakMemory()
+{
+#ifdef Q_OS_LINUX
+    QFile clearRefs("/proc/self/clear_refs");
+    if(clearRefs.open(QIODevice::WriteOnly))
+        clearRefs.write("5");
+#endif
+}
+
+/**
+ * @brief keywordCase
+ * @param n
+ * n个互不相同的关键字的长选择 kwa|kwb|...，考察长选择下的NFA与最小化规模
+ */
+static BenchCase keywordCase(int n)
+{
+    QStringList words;
+    for(int i=0;i<n;i++)
+    {
+        QString word="kw";
+        for(int v=i;;v/=26)
+        {
+            word+=QChar('a'+v%26);
+            if(v<26)break;
+        }
+        words.append(word);
+    }
+    return {"keywords", n, {words.join('|')}};
+}
+
+/**
+ * @brief nestedStarCase
+ * @param depth
+ * 嵌套闭包 ((((a)*b)*c)*...)*，考察epsilon闭包的规模
+ */
+static BenchCase nestedStarCase(int depth)
+{
+    QString regex="a";
+    for(int i=1;i<depth;i++)
+        regex="("+regex+")*"+QChar('a'+i%26);
+    return {"nested-star", depth, {"("+regex+")*"}};
+}
+
+/**
+ * @brief blowupCase
+ * @param n
+ * (a|b)*a(a|b)^n：倒数第n+1个字符为a，最小DFA有2^(n+1)个状态
+ */
+static BenchCase blowupCase(int n)
+{
+    QString regex="(a|b)*a";
+    for(int i=0;i<n;i++)
+        regex+="(a|b)";
+    return {"blowup", n, {regex}};
+}
+
+/**
+ * @brief miniCCase
+ * 与教学样例相同的MiniC词法规则
+ */
+static BenchCase miniCCase()
+{
+    return {"minic", 1, {"%rules",
+                         "%keyword if|then|else|end|repeat|until|read|write",
+                         "ID      \\letter\\(\\letter\\|\\digit\\)*",
+                         "NUM     \\digit\\\\digit\\*",
+                         "%skip COMMENT \\{\\\\~\\*\\}\\",
+                         "ASSIGN  :=",
+                         "OP      \\+\\|-|\\*\\|/|=|<",
+                         "DELIM   \\(\\|\\)\\|;"}};
+}
+
+/**
+ * @brief buildNFA
+ * @return 是否成功
+ * 按文件格式（多规则或单条正则表达式）构造NFA
+ */
+static bool buildNFA(NDFA &ndfa, const QStringList &lines)
+{
+    if(NDFA::isRuleFile(lines))
+    {
+        QList<NDFA::LexRule> rules;
+        QString keywordStr, errorStr;
+        if(!NDFA::parseRules(lines, rules, keywordStr, errorStr))
+        {
+            QTextStream(stderr)<<errorStr<<"\n";
+            return false;
+        }
+        ndfa.setKeywordStr(keywordStr);
+        if(!ndfa.rules2NFA(rules))
+        {
+            QTextStream(stderr)<<ndfa.errorString()<<"\n";
+            return false;
+        }
+    }
+    else
+    {
+        ndfa.setKeywordStr(lines.value(1).trimmed());
+        if(!ndfa.reg2NFA(lines.value(0).trimmed()))
+        {
+            QTextStream(stderr)<<ndfa.errorString()<<"\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief runCase
+ * @return 是否成功
+ * 重复repeat次完整流程，每个阶段取最短耗时；
+ * 闭包在NFA2DFA之前单独求出，NFA2DFA的耗时因而只含子集构造本身；
+ * followpos构造没有闭包，reg2NFA的耗时含求followpos
+ */
+static bool runCase(const BenchCase &benchCase, int repeat, NDFA::ConstructEngine construct,
+                    NDFA::MinimizeEngine engine, int threads, BenchResult &result)
+{
+    auto keepMin=[](qint64 &best, qint64 t){
+        if(best<0 || t<best)best=t;
+    };
+
+    resetPeakMemory();
+    const QString outPath=QDir::tempPath();
+    for(int r=0;r<repeat;r++)
+    {
+        NDFA ndfa;
+        ndfa.setConstructEngine(construct);
+        ndfa.setMinimizeEngine(engine);
+        ndfa.setDeterminizeThreads(threads);
+        QElapsedTimer timer;
+
+        timer.start();
+        if(!buildNFA(ndfa, benchCase.lines))
+            return false;
+        keepMin(result.reg2NFA, timer.nsecsElapsed());
+
+        timer.restart();
+        ndfa.precomputeClosures();
+        keepMin(result.closure, timer.nsecsElapsed());
+
+        timer.restart();
+        ndfa.NFA2DFA();
+        keepMin(result.NFA2DFA, timer.nsecsElapsed());
+
+        timer.restart();
+        ndfa.DFA2mDFA();
+        keepMin(result.DFA2mDFA, timer.nsecsElapsed());
+
+        timer.restart();
+        QString lexCode=ndfa.mDFA2Lexer(outPath);
+        keepMin(result.mDFA2Lexer, timer.nsecsElapsed());
+
+        result.stats=ndfa.phaseStats();
+    }
+    result.peakKiB=readProcStatus("VmHWM");
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setApplicationName("r2lexer-bench");
+    QCoreApplication::setApplicationVersion("1.0");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Reg2Lexer 基准测试：分阶段计时 reg2NFA / 闭包 / NFA2DFA / DFA2mDFA / mDFA2Lexer");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    QCommandLineOption repeatOption(QStringList()<<"r"<<"repeat", "每个用例重复次数，取最短耗时（默认3）", "n", "3");
+    QCommandLineOption familyOption(QStringList()<<"f"<<"family",
+                                    "只运行指定的族：keywords、nested-star、blowup、minic、file（可多次指定）", "name");
+    QCommandLineOption scaleOption(QStringList()<<"scale",
+                                   "规模档位（1~3，默认2），档位越高用例越大", "level", "2");
+    QCommandLineOption minimizeOption(QStringList()<<"m"<<"minimize",
+                                      "DFA最小化算法：hopcroft（默认）或 iterative", "engine", "hopcroft");
+    QCommandLineOption constructOption(QStringList()<<"c"<<"construct",
+                                       "DFA构造方式：thompson（默认）、followpos，或both（每个用例两种各运行一次）",
+                                       "engine", "thompson");
+    QCommandLineOption jobsOption(QStringList()<<"j"<<"jobs", "子集构造的工作线程数（默认1）", "n", "1");
+    QCommandLineOption csvOption(QStringList()<<"csv", "以CSV格式输出，便于与历史结果比对");
+    parser.addOption(repeatOption);
+    parser.addOption(familyOption);
+    parser.addOption(scaleOption);
+    parser.addOption(minimizeOption);
+    parser.addOption(constructOption);
+    parser.addOption(jobsOption);
+    parser.addOption(csvOption);
+    parser.addPositionalArgument("files", "额外的正则表达式文件，归入file族", "[file]...");
+    parser.process(a);
+
+    qInstallMessageHandler(quietMessageHandler);
+
+    const int repeat=qMax(1, parser.value(repeatOption).toInt());
+    const int scale=qBound(1, parser.value(scaleOption).toInt(), 3);
+    const QStringList families=parser.values(familyOption);
+    auto wanted=[&](const QString &family){
+        return families.isEmpty() || families.contains(family);
+    };
+
+    NDFA::MinimizeEngine engine=NDFA::HopcroftMinimize;
+    if(parser.value(minimizeOption)=="iterative")
+        engine=NDFA::IterativeMinimize;
+    else if(parser.value(minimizeOption)!="hopcroft")
+    {
+        QTextStream(stderr)<<"未知的最小化算法: "<<parser.value(minimizeOption)<<"\n";
+        return 1;
+    }
+    QList<NDFA::ConstructEngine> constructs;
+    const QString construct=parser.value(constructOption);
+    if(construct=="thompson" || construct=="both")
+        constructs.append(NDFA::ThompsonConstruct);
+    if(construct=="followpos" || construct=="both")
+        constructs.append(NDFA::FollowposConstruct);
+    if(constructs.isEmpty())
+    {
+        QTextStream(stderr)<<"未知的DFA构造方式: "<<construct<<"\n";
+        return 1;
+    }
+    const int threads=qMax(1, parser.value(jobsOption).toInt());
+
+    //各族的规模按档位递增
+    QList<BenchCase> cases;
+    if(wanted("keywords"))
+        for(int n=64;n<=(scale==1 ? 256 : scale==2 ? 1024 : 4096);n*=4)
+            cases.append(keywordCase(n));
+    if(wanted("nested-star"))
+        for(int depth=4;depth<=(scale==1 ? 16 : scale==2 ? 64 : 256);depth*=2)
+            cases.append(nestedStarCase(depth));
+    if(wanted("blowup"))
+        for(int n=4;n<=(scale==1 ? 8 : scale==2 ? 12 : 16);n+=2)
+            cases.append(blowupCase(n));
+    if(wanted("minic"))
+        cases.append(miniCCase());
+    if(wanted("file"))
+        for(const auto &filePath: parser.positionalArguments())
+        {
+            QFile srcFile(filePath);
+            if(!srcFile.open(QIODevice::ReadOnly|QIODevice::Text))
+            {
+                QTextStream(stderr)<<"无法打开正则表达式文件: "<<filePath<<"\n";
+                return 1;
+            }
+            QStringList lines=QString::fromUtf8(srcFile.readAll()).split('\n');
+            cases.append({QFileInfo(filePath).fileName(), 1, lines});
+        }
+
+    QTextStream out(stdout);
+    const bool csv=parser.isSet(csvOption);
+    auto ms=[](qint64 ns){
+        return QString::number(ns/1e6, 'f', 3);
+    };
+    //NFA一列在followpos构造时为位置数；construct列追加在末尾，不影响已有列的位置
+    if(csv)
+        out<<"family,size,reg2NFA_ms,closure_ms,NFA2DFA_ms,DFA2mDFA_ms,mDFA2Lexer_ms,NFA,DFA,mDFA,classes,peak_KiB,construct\n";
+    else
+        out<<QString("%1 %2 %3 %4 %5 %6 %7 %8 %9 %10 %11 %12\n")
+             .arg("family",-14).arg("size",6).arg("reg2NFA",10).arg("closure",10).arg("NFA2DFA",10)
+             .arg("DFA2mDFA",10).arg("mDFA2Lexer",10).arg("NFA",8).arg("DFA",8).arg("mDFA",8).arg("peakKiB",9)
+             .arg("construct",10);
+
+    int failCount=0;
+    for(const auto &benchCase: cases)
+    {
+        for(const auto &construct: constructs)
+        {
+            BenchResult result;
+            if(!runCase(benchCase, repeat, construct, engine, threads, result))
+            {
+                failCount++;
+                continue;
+            }
+            const NDFA::PhaseStats &stats=result.stats;
+            const bool followpos=construct==NDFA::FollowposConstruct;
+            const int NFASize=followpos ? stats.positionNum : stats.NFAStateNum;
+            const QString constructName=followpos ? "followpos" : "thompson";
+            if(csv)
+                out<<benchCase.family<<","<<benchCase.size<<","<<ms(result.reg2NFA)<<","<<ms(result.closure)<<","
+                   <<ms(result.NFA2DFA)<<","<<ms(result.DFA2mDFA)<<","<<ms(result.mDFA2Lexer)<<","
+                   <<NFASize<<","<<stats.DFAStateNum<<","<<stats.mDFAStateNum<<","<<stats.classNum<<","
+                   <<result.peakKiB<<","<<constructName<<"\n";
+            else
+                out<<QString("%1 %2 %3 %4 %5 %6 %7 %8 %9 %10 %11 %12\n")
+                     .arg(benchCase.family,-14).arg(benchCase.size,6).arg(ms(result.reg2NFA),10)
+                     .arg(ms(result.closure),10).arg(ms(result.NFA2DFA),10).arg(ms(result.DFA2mDFA),10)
+                     .arg(ms(result.mDFA2Lexer),10).arg(NFASize,8).arg(stats.DFAStateNum,8)
+                     .arg(stats.mDFAStateNum,8).arg(result.peakKiB,9).arg(constructName,10);
+            out.flush();
+        }
+    }
+
+    return failCount ? 1 : 0;
+}
@@ -0,0 +1,12 @@
+# 生成的词法分析程序的吞吐量测试，运行时调用本机C++编译器（及可选的perf）
+QT       = core
+
+CONFIG += c++17 console release
+CONFIG -= app_bundle
+
+TARGET = r2lexer-throughput
+
+include(../../ndfa.pri)
+
+SOURCES += \
+    main.cpp
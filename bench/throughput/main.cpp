@@ -0,0 +1,437 @@
+/****************************************************
+ * @Copyright © 2021-2023 Lyuyk. All rights reserved.
+ *
+ * @FileName: bench/throughput/main.cpp
+ * @Brief: 生成的词法分析程序的吞吐量测试
+ * @Module Function: 由词法规则文件生成各后端的词法分析程序，以本机编译器编译，
+ *                   在合成语料（沿最小化DFA随机游走生成）与真实语料上运行，
+ *                   报告 MB/s、单词/秒，以及（有perf时）每字节指令数
+ *
+ * @Current Version: 1.0
+ * @Author: Lyuyk
+ * @Modifier: Lyuyk
+ * @Finished Date: 2026/10/16
+ *
+ * @Version History: 1.0 current version
+ *
+ ****************************************************/
+#include "ndfa.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+#include <random>
+
+//一种被测的词法分析程序：生成方式 × 输入方式
+struct LexerVariant
+{
+    QString name;//如 switch/mmap
+    QString exePath;
+};
+
+//一份语料
+struct Corpus
+{
+    QString name;
+    QString path;
+    qint64 bytes;
+    qint64 tokens;//由进程内扫描器计数，与生成的词法分析程序划分单词的方式相同
+};
+
+static void quietMessageHandler(QtMsgType type, const QMessageLogContext &, const QString &msg)
+{
+    if(type==QtDebugMsg || type==QtInfoMsg)
+        return;
+    QTextStream(stderr)<<msg<<"\n";
+}
+
+/**
+ * @brief buildLexer
+ * @return 生成的词法分析程序代码，规则文件有误时为空
+ * 与命令行工具相同：多规则文件按规则编译，否则第一行为正则表达式，第二行为关键字
+ */
+static QString buildLexer(NDFA &ndfa, const QStringList &lines, const QString &outPath)
+{
+    ndfa.init();
+    if(NDFA::isRuleFile(lines))
+    {
+        QList<NDFA::LexRule> rules;
+        QString keywordStr, errorStr;
+        if(!NDFA::parseRules(lines, rules, keywordStr, errorStr))
+        {
+            QTextStream(stderr)<<errorStr<<"\n";
+            return QString();
+        }
+        ndfa.setKeywordStr(keywordStr);
+        if(!ndfa.rules2NFA(rules))
+        {
+            QTextStream(stderr)<<ndfa.errorString()<<"\n";
+            return QString();
+        }
+    }
+    else
+    {
+        ndfa.setKeywordStr(lines.value(1).trimmed());
+        if(!ndfa.reg2NFA(lines.value(0).trimmed()))
+        {
+            QTextStream(stderr)<<ndfa.errorString()<<"\n";
+            return QString();
+        }
+    }
+    ndfa.NFA2DFA();
+    ndfa.DFA2mDFA();
+    return ndfa.mDFA2Lexer(outPath);
+}
+
+/**
+ * @brief synthesizeCorpus
+ * @param table
+ * @param size
+ * @param seed
+ * @return 合成语料，DFA无法接受任何可打印串时为空
+ * 从初态出发沿最小化DFA随机游走，只走可打印字节（不含空白），到达终态后随机结束一个单词；
+ * 单词过长时沿到终态距离递减的边收尾。单词间以空格分隔，每8个单词换行
+ */
+static QByteArray synthesizeCorpus(const LexTable &table, qint64 size, quint32 seed)
+{
+    const int maxTokenLen=16;
+    const int INF=0x3f3f3f3f;
+
+    //字符类→可打印字节
+    QList<QList<char>> classBytes(table.classNum);
+    for(int b=33;b<127;b++)
+        classBytes[table.byteClass[b]].append(char(b));
+
+    //各状态到最近终态的步数（反向宽度优先）
+    QList<int> dist(table.stateNum, INF);
+    QList<int> queue;
+    for(int s=0;s<table.stateNum;s++)
+        if(table.accept[s]>=0)
+        {
+            dist[s]=0;
+            queue.append(s);
+        }
+    for(int head=0;head<queue.size();head++)
+    {
+        int t=queue[head];
+        for(int s=0;s<table.stateNum;s++)
+        {
+            if(dist[s]!=INF)
+                continue;
+            for(int c=0;c<table.classNum;c++)
+                if(!classBytes[c].isEmpty() && table.trans[s*table.classNum+c]==t)
+                {
+                    dist[s]=dist[t]+1;
+                    queue.append(s);
+                    break;
+                }
+        }
+    }
+    if(!table.isValid() || dist[table.startState]==INF)
+        return QByteArray();
+
+    std::mt19937 rng(seed);
+    QByteArray corpus;
+    corpus.reserve(size+maxTokenLen*4);
+    QList<int> candidates;
+    int tokenNum=0;
+    while(corpus.size()<size)
+    {
+        int state=table.startState;
+        int len=0;
+        for(;;)
+        {
+            //可走且走后仍能到达终态的字符类；过长时只走离终态更近的
+            candidates.clear();
+            for(int c=0;c<table.classNum;c++)
+            {
+                if(classBytes[c].isEmpty())
+                    continue;
+                int to=table.trans[state*table.classNum+c];
+                if(to<0 || dist[to]==INF || (len>=maxTokenLen && dist[to]>=dist[state]))
+                    continue;
+                candidates.append(c);
+            }
+            bool canStop=len>0 && table.accept[state]>=0;
+            if(canStop && (candidates.isEmpty() || len>=maxTokenLen || rng()%4==0))
+                break;
+            if(candidates.isEmpty())//初态为终态但无可打印字节可走，只接受空串
+                return QByteArray();
+
+            int c=candidates[rng()%candidates.size()];
+            const QList<char> &bytes=classBytes[c];
+            corpus.append(bytes[rng()%bytes.size()]);
+            state=table.trans[state*table.classNum+c];
+            len++;
+        }
+        corpus.append(++tokenNum%8 ? ' ' : '\n');
+    }
+    return corpus;
+}
+
+/**
+ * @brief tileCorpus
+ * 将真实语料首尾相接重复到不小于size字节
+ */
+static QByteArray tileCorpus(const QByteArray &data, qint64 size)
+{
+    QByteArray corpus;
+    if(data.isEmpty())
+        return corpus;
+    while(corpus.size()<size)
+    {
+        corpus.append(data);
+        corpus.append('\n');
+    }
+    return corpus;
+}
+
+/**
+ * @brief runProcess
+ * @return 退出码为0时返回true
+ * 运行外部程序，标准输出丢弃，失败时输出其标准错误
+ */
+static bool runProcess(const QString &program, const QStringList &arguments)
+{
+    QProcess process;
+    process.setStandardOutputFile(QProcess::nullDevice());
+    process.start(program, arguments);
+    if(!process.waitForStarted() || !process.waitForFinished(-1))
+    {
+        QTextStream(stderr)<<program<<": "<<process.errorString()<<"\n";
+        return false;
+    }
+    if(process.exitStatus()!=QProcess::NormalExit || process.exitCode()!=0)
+    {
+        QTextStream(stderr)<<program<<" 运行失败:\n"<<QString::fromUtf8(process.readAllStandardError());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief countInstructions
+ * @return 用户态指令数，perf不可用或不支持该事件时为-1
+ * 以 perf stat -x, -e instructions:u 统计一次运行
+ */
+static qint64 countInstructions(const QString &perfPath, const QString &statPath,
+                                const QString &exePath, const QString &corpusPath)
+{
+    if(perfPath.isEmpty())
+        return -1;
+    if(!runProcess(perfPath, {"stat", "-x", ",", "-e", "instructions:u", "-o", statPath,
+                              "--", exePath, corpusPath, QProcess::nullDevice()}))
+        return -1;
+
+    QFile statFile(statPath);
+    if(!statFile.open(QIODevice::ReadOnly|QIODevice::Text))
+        return -1;
+    const QList<QByteArray> lines=statFile.readAll().split('\n');
+    for(const auto &line: lines)
+        if(line.contains("instructions"))
+        {
+            bool ok=false;
+            qint64 count=line.split(',').value(0).toLongLong(&ok);
+            return ok ? count : -1;
+        }
+    return -1;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setApplicationName("r2lexer-throughput");
+    QCoreApplication::setApplicationVersion("1.0");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Reg2Lexer 吞吐量测试：编译并运行生成的词法分析程序，报告各后端的 MB/s、单词/秒与每字节指令数");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    QCommandLineOption sizeOption(QStringList()<<"size", "语料大小（MiB，默认16）", "MiB", "16");
+    QCommandLineOption corpusOption(QStringList()<<"corpus", "真实语料文件，重复拼接到--size大小（可多次指定）", "file");
+    QCommandLineOption seedOption(QStringList()<<"seed", "合成语料的随机种子（默认1）", "n", "1");
+    QCommandLineOption repeatOption(QStringList()<<"r"<<"repeat", "每项运行次数，取最短耗时（默认3）", "n", "3");
+    QCommandLineOption compilerOption(QStringList()<<"cc", "C++编译器（默认取环境变量CXX，否则c++）", "compiler");
+    QCommandLineOption cflagsOption(QStringList()<<"cflags", "编译选项（默认-O2）", "flags", "-O2");
+    QCommandLineOption backendOption(QStringList()<<"b"<<"backend",
+                                     "只测指定的生成方式：switch 或 table（可多次指定，默认全部）", "backend");
+    QCommandLineOption noPerfOption(QStringList()<<"no-perf", "不调用perf统计指令数");
+    QCommandLineOption keepOption(QStringList()<<"keep", "保留生成的代码、程序与语料所在的临时目录");
+    parser.addOption(sizeOption);
+    parser.addOption(corpusOption);
+    parser.addOption(seedOption);
+    parser.addOption(repeatOption);
+    parser.addOption(compilerOption);
+    parser.addOption(cflagsOption);
+    parser.addOption(backendOption);
+    parser.addOption(noPerfOption);
+    parser.addOption(keepOption);
+    parser.addPositionalArgument("rules", "词法规则文件（与命令行工具格式相同）", "<file>");
+    parser.process(a);
+
+    const QStringList files=parser.positionalArguments();
+    if(files.size()!=1)
+        parser.showHelp(1);
+    qInstallMessageHandler(quietMessageHandler);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QFile ruleFile(files[0]);
+    if(!ruleFile.open(QIODevice::ReadOnly|QIODevice::Text))
+    {
+        err<<"无法打开正则表达式文件: "<<files[0]<<"\n";
+        return 1;
+    }
+    const QStringList lines=QString::fromUtf8(ruleFile.readAll()).split('\n');
+    ruleFile.close();
+
+    QTemporaryDir workDir;
+    if(!workDir.isValid())
+    {
+        err<<"无法创建临时目录\n";
+        return 1;
+    }
+    workDir.setAutoRemove(!parser.isSet(keepOption));
+    if(parser.isSet(keepOption))
+        out<<"work dir: "<<workDir.path()<<"\n";
+
+    QString compiler=parser.value(compilerOption);
+    if(compiler.isEmpty())
+        compiler=qEnvironmentVariable("CXX", "c++");
+    const QStringList cflags=parser.value(cflagsOption).split(' ', Qt::SkipEmptyParts);
+    const QString perfPath=parser.isSet(noPerfOption) ? QString() : QStandardPaths::findExecutable("perf");
+    const int repeat=qMax(1, parser.value(repeatOption).toInt());
+    const qint64 size=qMax<qint64>(1, parser.value(sizeOption).toLongLong())<<20;
+
+    //生成并编译各种词法分析程序（生成的代码用到C++标准库，按C++编译）
+    QStringList backends=parser.values(backendOption);
+    if(backends.isEmpty())
+        backends<<"switch"<<"table";
+    NDFA ndfa;
+    QList<LexerVariant> variants;
+    for(const auto &backend: backends)
+    {
+        if(backend!="switch" && backend!="table")
+        {
+            err<<"未知的生成方式: "<<backend<<"\n";
+            return 1;
+        }
+        ndfa.setLexerBackend(backend=="table" ? NDFA::TableBackend : NDFA::SwitchBackend);
+        QString lexCode=buildLexer(ndfa, lines, workDir.path());
+        if(lexCode.isEmpty())
+            return 1;
+        QString srcPath=workDir.filePath(backend+"_lexer.c");
+        QFile srcFile(srcPath);
+        if(!srcFile.open(QIODevice::WriteOnly|QIODevice::Text|QIODevice::Truncate))
+        {
+            err<<"文件打开/写入失败: "<<srcPath<<"\n";
+            return 1;
+        }
+        srcFile.write(lexCode.toUtf8());
+        srcFile.close();
+
+        for(bool useMmap: {true, false})
+        {
+            LexerVariant variant;
+            variant.name=backend+(useMmap ? "/mmap" : "/read");
+            variant.exePath=workDir.filePath(backend+(useMmap ? "_mmap" : "_read"));
+            QStringList args=cflags;
+            if(!useMmap)
+                args<<"-DLEX_NO_MMAP";
+            args<<"-x"<<"c++"<<"-o"<<variant.exePath<<srcPath;
+            if(!runProcess(compiler, args))
+                return 1;
+            variants.append(variant);
+        }
+    }
+
+    //准备语料：合成语料 + 各真实语料，单词数由进程内扫描器统计
+    const LexTable table=ndfa.exportTable();
+    LexScanner scanner(table);
+    QList<QPair<QString, QByteArray>> corpusData;
+    QByteArray synthetic=synthesizeCorpus(table, size, parser.value(seedOption).toUInt());
+    if(synthetic.isEmpty())
+        err<<"DFA不接受任何可打印串，跳过合成语料\n";
+    else
+        corpusData.append({"synthetic", synthetic});
+    for(const auto &filePath: parser.values(corpusOption))
+    {
+        QFile corpusFile(filePath);
+        if(!corpusFile.open(QIODevice::ReadOnly))
+        {
+            err<<"无法打开输入文件: "<<filePath<<"\n";
+            return 1;
+        }
+        corpusData.append({QFileInfo(filePath).fileName(), tileCorpus(corpusFile.readAll(), size)});
+    }
+
+    out<<QString("%1 %2 %3 %4 %5\n").arg("corpus",-16).arg("lexer",-16).arg("MB/s",10).arg("Mtok/s",10).arg("instr/B",10);
+    for(int i=0;i<corpusData.size();i++)
+    {
+        Corpus corpus;
+        corpus.name=corpusData[i].first;
+        corpus.path=workDir.filePath(QString("corpus%1.txt").arg(i));
+        const QByteArray &data=corpusData[i].second;
+        corpus.bytes=data.size();
+        QFile corpusFile(corpus.path);
+        if(!corpusFile.open(QIODevice::WriteOnly|QIODevice::Truncate))
+        {
+            err<<"文件打开/写入失败: "<<corpus.path<<"\n";
+            return 1;
+        }
+        corpusFile.write(data);
+        corpusFile.close();
+
+        //进程内扫描器同时作为对照
+        qint64 bestNs=-1;
+        for(int r=0;r<repeat;r++)
+        {
+            QElapsedTimer timer;
+            timer.start();
+            qint64 tokens=0;
+            scanner.tokenize(data, [&](const LexScanner::Token &){
+                tokens++;
+                return true;
+            });
+            qint64 ns=timer.nsecsElapsed();
+            if(bestNs<0 || ns<bestNs)bestNs=ns;
+            corpus.tokens=tokens;
+        }
+        auto report=[&](const QString &lexer, qint64 ns, qint64 instructions){
+            double sec=qMax<qint64>(ns, 1)/1e9;
+            out<<QString("%1 %2 %3 %4 %5\n").arg(corpus.name,-16).arg(lexer,-16)
+                 .arg(corpus.bytes/sec/1e6, 10, 'f', 1).arg(corpus.tokens/sec/1e6, 10, 'f', 2)
+                 .arg(instructions<0 ? QString("n/a") : QString::number(double(instructions)/corpus.bytes, 'f', 2), 10);
+            out.flush();
+        };
+        report("in-process", bestNs, -1);
+
+        //生成的程序：计时含进程启动，语料足够大时可忽略
+        for(const auto &variant: variants)
+        {
+            bestNs=-1;
+            for(int r=0;r<repeat;r++)
+            {
+                QElapsedTimer timer;
+                timer.start();
+                if(!runProcess(variant.exePath, {corpus.path, QProcess::nullDevice()}))
+                    return 1;
+                qint64 ns=timer.nsecsElapsed();
+                if(bestNs<0 || ns<bestNs)bestNs=ns;
+            }
+            qint64 instructions=countInstructions(perfPath, workDir.filePath("perf.txt"), variant.exePath, corpus.path);
+            report(variant.name, bestNs, instructions);
+        }
+    }
+
+    return 0;
+}
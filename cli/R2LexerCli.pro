@@ -0,0 +1,17 @@
+# 命令行批量生成词法分析程序，不依赖QtWidgets
+QT       = core
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = r2lexer-cli
+
+include(../ndfa.pri)
+
+SOURCES += \
+    main.cpp
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
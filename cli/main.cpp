@@ -0,0 +1,503 @@
+/****************************************************
+ * @Copyright © 2021-2023 Lyuyk. All rights reserved.
+ *
+ * @FileName: cli/main.cpp
+ * @Brief: 命令行批量生成词法分析程序
+ * @Module Function: 读取若干正则表达式文件，依次执行
+ *                   reg2NFA → NFA2DFA → DFA2mDFA → mDFA2Lexer，
+ *                   将生成的Lexer代码写入输出目录
+ *
+ * @Current Version: 1.0
+ * @Author: Lyuyk
+ * @Modifier: Lyuyk
+ * @Finished Date: 2026/10/16
+ *
+ * @Version History: 1.0 current version
+ *
+ ****************************************************/
+#include "lexcache.h"
+#include "leximage.h"
+#include "ndfa.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QScopedPointer>
+#include <QTextStream>
+#include <QThread>
+
+/**
+ * @brief quietMessageHandler
+ * 批量模式下屏蔽转换过程中的qDebug调试输出
+ */
+static void quietMessageHandler(QtMsgType type, const QMessageLogContext &, const QString &msg)
+{
+    if(type==QtDebugMsg || type==QtInfoMsg)
+        return;
+    QTextStream(stderr)<<msg<<"\n";
+}
+
+/**
+ * @brief readRegexFile
+ * @param filePath
+ * @param lines
+ * @return 是否读取成功
+ * 按行读取正则表达式文件
+ */
+static bool readRegexFile(const QString &filePath, QStringList &lines)
+{
+    QFile srcFile(filePath);
+    if(!srcFile.open(QIODevice::ReadOnly|QIODevice::Text))
+        return false;
+    QTextStream textInput(&srcFile);
+    textInput.setEncoding(QStringConverter::Utf8);//设置编码，防止中文乱码
+
+    while(!textInput.atEnd())
+        lines.append(textInput.readLine());
+    srcFile.close();
+    return true;
+}
+
+//单个文件的编译结果
+struct CompileResult
+{
+    bool cached=false;//命中缓存，未执行转换
+    QString imagePath;//缓存中的自动机文件，未启用缓存或写入失败时为空
+};
+
+/**
+ * @brief compileRegexFile
+ * @param ndfa
+ * @param filePath
+ * @param outDir
+ * @param NFAOnly
+ * @param cache 为空时不使用缓存
+ * @param result
+ * @return 是否生成成功
+ * 对单个正则表达式文件执行完整转换流程，输出 <文件名>_lexer.c。
+ * 文件为多规则格式（首行%rules）时按规则编译，否则与图形界面相同：第一行为正则表达式，第二行为关键字。
+ * NFAOnly为真时只构造NFA，不确定化也不生成代码（惰性DFA模式）。
+ * 启用缓存时以规则文本、生成方式与输出目录为键，命中则直接取出生成的代码
+ */
+static bool compileRegexFile(NDFA &ndfa, const QString &filePath, const QDir &outDir, bool NFAOnly,
+                             LexCache *cache, CompileResult &result)
+{
+    QTextStream err(stderr);
+
+    QStringList lines;
+    if(!readRegexFile(filePath, lines))
+    {
+        err<<"无法打开正则表达式文件: "<<filePath<<"\n";
+        return false;
+    }
+
+    QString lexCode;
+    QByteArray cacheKey;
+    if(cache && !NFAOnly)
+    {
+        QStringList ruleLines=NDFA::isRuleFile(lines) ? lines
+                                                      : QStringList{lines.value(0).trimmed(), lines.value(1).trimmed()};
+        QStringList options{"construct="+QString::number(ndfa.constructEngine()),
+                            "backend="+QString::number(ndfa.lexerBackend()),
+                            "minimize="+QString::number(ndfa.minimizeEngine()),
+                            "out="+outDir.absolutePath()};
+        cacheKey=LexCache::key(ruleLines, options);
+        if(cache->lookup(cacheKey, lexCode))
+        {
+            result.cached=true;
+            result.imagePath=cache->automatonPath(cacheKey);
+        }
+    }
+
+    ndfa.init();//同一对象复用，每个文件前复位
+    if(!result.cached)
+    {
+        if(NDFA::isRuleFile(lines))
+        {
+            QList<NDFA::LexRule> rules;
+            QString keywordStr, errorStr;
+            if(!NDFA::parseRules(lines, rules, keywordStr, errorStr))
+            {
+                err<<filePath<<": "<<errorStr<<"\n";
+                return false;
+            }
+            ndfa.setKeywordStr(keywordStr);
+            if(!ndfa.rules2NFA(rules))
+            {
+                err<<filePath<<": "<<ndfa.errorString()<<"\n";
+                return false;
+            }
+        }
+        else
+        {
+            QString regexStr=lines.value(0).trimmed();
+            if(regexStr.isEmpty())
+            {
+                err<<"正则表达式为空: "<<filePath<<"\n";
+                return false;
+            }
+            ndfa.setKeywordStr(lines.value(1).trimmed());
+            if(!ndfa.reg2NFA(regexStr))
+            {
+                err<<filePath<<": "<<ndfa.errorString()<<"\n";
+                return false;
+            }
+        }
+        if(NFAOnly)
+            return true;
+        ndfa.NFA2DFA();
+        ndfa.DFA2mDFA();
+        lexCode=ndfa.mDFA2Lexer(outDir.absolutePath());
+        if(cache && cache->store(cacheKey, lexCode, ndfa.exportTable()))
+            result.imagePath=cache->automatonPath(cacheKey);
+    }
+
+    QString tgtFilePath=outDir.filePath(QFileInfo(filePath).completeBaseName()+"_lexer.c");
+    QFile tgtFile(tgtFilePath);
+    if(!tgtFile.open(QIODevice::WriteOnly|QIODevice::Text|QIODevice::Truncate))
+    {
+        err<<"文件打开/写入失败: "<<tgtFilePath<<"\n";
+        return false;
+    }
+    QTextStream outputFile(&tgtFile);
+    outputFile<<lexCode;
+    tgtFile.close();
+    return true;
+}
+
+/**
+ * @brief readInputFile
+ * @param filePath
+ * @param data
+ * @return 是否读取成功
+ * 读入待分词的输入文件
+ */
+static bool readInputFile(const QString &filePath, QByteArray &data)
+{
+    QFile inputFile(filePath);
+    if(!inputFile.open(QIODevice::ReadOnly))
+    {
+        QTextStream(stderr)<<"无法打开输入文件: "<<filePath<<"\n";
+        return false;
+    }
+    data=inputFile.readAll();
+    inputFile.close();
+    return true;
+}
+
+/**
+ * @brief scanFile
+ * @param scanner
+ * @param filePath
+ * @param outFile 单词的输出目标
+ * @return 是否扫描成功
+ * 用进程内扫描器对输入文件分词，每行输出一个单词“类别名:单词”
+ */
+static bool scanFile(const LexScanner &scanner, const QString &filePath, FILE *outFile)
+{
+    QByteArray data;
+    if(!readInputFile(filePath, data))
+        return false;
+
+    QTextStream out(outFile);
+    scanner.tokenize(data, [&](const LexScanner::Token &token){
+        out<<scanner.ruleName(token.rule)<<":"<<QString::fromUtf8(data.constData()+token.offset, token.length)<<"\n";
+        return true;
+    });
+    return true;
+}
+
+/**
+ * @brief scanFileLazy
+ * @param nfa
+ * @param filePath
+ * @param memoryBudget
+ * @param stats
+ * @param outFile
+ * @return 是否扫描成功
+ * 与scanFile相同，但由惰性DFA边扫描边确定化，DFA状态缓存不超过memoryBudget字节
+ */
+static bool scanFileLazy(const LexNFA &nfa, const QString &filePath, qsizetype memoryBudget, bool stats, FILE *outFile)
+{
+    QByteArray data;
+    if(!readInputFile(filePath, data))
+        return false;
+
+    QTextStream out(outFile);
+    LazyDFA lazyDFA(nfa, memoryBudget);
+    lazyDFA.tokenize(data, [&](const LexScanner::Token &token){
+        out<<lazyDFA.ruleName(token.rule)<<":"<<QString::fromUtf8(data.constData()+token.offset, token.length)<<"\n";
+        return true;
+    });
+    if(stats)
+    {
+        const LazyDFA::CacheStats &cache=lazyDFA.cacheStats();
+        out<<"  lazy DFA: "<<cache.statesBuilt<<" states built, "<<cache.cacheFlushes<<" flushes, "
+           <<cache.transHits<<" hits, "<<cache.transMisses<<" misses\n";
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);//仅用于解析参数，不进入事件循环
+    QCoreApplication::setApplicationName("r2lexer-cli");
+    QCoreApplication::setApplicationVersion("1.0");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Reg2Lexer 命令行工具：由正则表达式文件批量生成词法分析程序");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    QCommandLineOption outDirOption(QStringList()<<"o"<<"output",
+                                    "词法分析程序输出目录（默认为当前目录）", "dir", ".");
+    QCommandLineOption verboseOption(QStringList()<<"V"<<"verbose", "输出转换过程的调试信息");
+    QCommandLineOption statsOption(QStringList()<<"s"<<"stats", "输出各阶段状态数与索引查询统计");
+    QCommandLineOption minimizeOption(QStringList()<<"m"<<"minimize",
+                                      "DFA最小化算法：hopcroft（默认）或 iterative", "engine", "hopcroft");
+    parser.addOption(outDirOption);
+    parser.addOption(verboseOption);
+    parser.addOption(statsOption);
+    QCommandLineOption backendOption(QStringList()<<"b"<<"backend",
+                                     "词法分析程序生成方式：switch（默认）或 table", "backend", "switch");
+    QCommandLineOption scanOption(QStringList()<<"scan",
+                                  "生成后用进程内扫描器对该文件分词并输出单词", "input");
+    QCommandLineOption lazyOption(QStringList()<<"l"<<"lazy",
+                                  "只构造NFA，以惰性DFA（状态缓存上限为bytes字节）对--scan输入分词，不生成词法分析程序",
+                                  "bytes");
+    QCommandLineOption jobsOption(QStringList()<<"j"<<"jobs",
+                                  "子集构造的工作线程数（默认1；0为处理器核数）", "n", "1");
+    QCommandLineOption constructOption(QStringList()<<"c"<<"construct",
+                                       "DFA构造方式：thompson（默认，Thompson NFA+子集构造）或 followpos（由语法树直接构造）",
+                                       "engine", "thompson");
+    parser.addOption(constructOption);
+    parser.addOption(minimizeOption);
+    parser.addOption(backendOption);
+    parser.addOption(jobsOption);
+    parser.addOption(scanOption);
+    parser.addOption(lazyOption);
+    QCommandLineOption statsJsonOption(QStringList()<<"stats-json",
+                                       "将各文件各阶段的耗时与计数以JSON数组写入该文件（-为标准输出，其余输出改到标准错误）", "file");
+    parser.addOption(statsJsonOption);
+    QCommandLineOption automatonOption(QStringList()<<"a"<<"automaton",
+                                       "同时将最小化DFA写为可内存映射的自动机文件 <文件名>.r2la");
+    QCommandLineOption loadOption(QStringList()<<"load",
+                                  "不编译规则，直接映射已编译的自动机文件并对--scan输入分词", "r2la");
+    QCommandLineOption cacheOption(QStringList()<<"cache",
+                                   "编译结果缓存目录：规则文本与选项相同时直接取出上次生成的代码与自动机", "dir");
+    parser.addOption(automatonOption);
+    parser.addOption(loadOption);
+    parser.addOption(cacheOption);
+    parser.addPositionalArgument("files", "正则表达式文件（第一行正则表达式，第二行关键字；或以%rules开头的多规则文件）", "<file>...");
+    parser.process(a);
+
+    //加载已编译的自动机，无需规则文件
+    if(parser.isSet(loadOption))
+    {
+        if(!parser.isSet(scanOption))
+        {
+            QTextStream(stderr)<<"--load 需与 --scan 同时使用\n";
+            return 1;
+        }
+        LexImage image;
+        QString errorStr;
+        if(!image.open(parser.value(loadOption), &errorStr))
+        {
+            QTextStream(stderr)<<errorStr<<"\n";
+            return 1;
+        }
+        return scanFile(LexScanner(image), parser.value(scanOption), stdout) ? 0 : 1;
+    }
+
+    const QStringList files=parser.positionalArguments();
+    if(files.isEmpty())
+        parser.showHelp(1);
+
+    if(!parser.isSet(verboseOption))
+        qInstallMessageHandler(quietMessageHandler);
+
+    QDir outDir(parser.value(outDirOption));
+    if(!outDir.exists() && !outDir.mkpath("."))
+    {
+        QTextStream(stderr)<<"无法创建输出目录: "<<outDir.path()<<"\n";
+        return 1;
+    }
+
+    NDFA ndfa;
+    QString construct=parser.value(constructOption);
+    if(construct=="followpos")
+        ndfa.setConstructEngine(NDFA::FollowposConstruct);
+    else if(construct!="thompson")
+    {
+        QTextStream(stderr)<<"未知的DFA构造方式: "<<construct<<"\n";
+        return 1;
+    }
+
+    QString engine=parser.value(minimizeOption);
+    if(engine=="iterative")
+        ndfa.setMinimizeEngine(NDFA::IterativeMinimize);
+    else if(engine!="hopcroft")
+    {
+        QTextStream(stderr)<<"未知的最小化算法: "<<engine<<"\n";
+        return 1;
+    }
+
+    QString backend=parser.value(backendOption);
+    if(backend=="table")
+        ndfa.setLexerBackend(NDFA::TableBackend);
+    else if(backend!="switch")
+    {
+        QTextStream(stderr)<<"未知的生成方式: "<<backend<<"\n";
+        return 1;
+    }
+
+    bool jobsOk=false;
+    int jobs=parser.value(jobsOption).toInt(&jobsOk);
+    if(!jobsOk || jobs<0)
+    {
+        QTextStream(stderr)<<"无效的线程数: "<<parser.value(jobsOption)<<"\n";
+        return 1;
+    }
+    ndfa.setDeterminizeThreads(jobs ? jobs : QThread::idealThreadCount());
+
+    bool lazy=parser.isSet(lazyOption);
+    qsizetype lazyBudget=0;
+    if(lazy)
+    {
+        bool ok=false;
+        lazyBudget=parser.value(lazyOption).toLongLong(&ok);
+        if(!ok || lazyBudget<=0 || !parser.isSet(scanOption))
+        {
+            QTextStream(stderr)<<"--lazy 需要正整数的缓存上限，并与 --scan 同时使用\n";
+            return 1;
+        }
+        if(ndfa.constructEngine()!=NDFA::ThompsonConstruct)
+        {
+            QTextStream(stderr)<<"--lazy 按需确定化NFA，只能与Thompson构造同时使用\n";
+            return 1;
+        }
+    }
+
+    QScopedPointer<LexCache> cache;
+    if(parser.isSet(cacheOption) && !lazy)
+    {
+        cache.reset(new LexCache(parser.value(cacheOption)));
+        if(!cache->isValid())
+        {
+            QTextStream(stderr)<<"无法创建缓存目录: "<<parser.value(cacheOption)<<"\n";
+            return 1;
+        }
+    }
+
+    int failCount=0;
+    QJsonArray statsArray;
+    //JSON写到标准输出时，其余输出改到标准错误，使标准输出只有JSON文档
+    FILE *outFile=parser.value(statsJsonOption)=="-" ? stderr : stdout;
+    for(const auto &filePath: files)
+    {
+        CompileResult result;
+        if(!compileRegexFile(ndfa, filePath, outDir, lazy, cache.data(), result))
+        {
+            failCount++;
+            continue;
+        }
+
+        if(lazy)
+        {
+            if(!scanFileLazy(ndfa.exportNFA(), parser.value(scanOption), lazyBudget, parser.isSet(statsOption), outFile))
+                failCount++;
+            continue;
+        }
+
+        QTextStream out(outFile);
+        out<<filePath<<" -> "<<QFileInfo(filePath).completeBaseName()<<"_lexer.c"<<(result.cached ? " (cached)" : "")<<"\n";
+        const NDFA::PhaseStats &stats=ndfa.phaseStats();
+        if(parser.isSet(statsOption) && !result.cached)
+        {
+            out<<"  rules: "<<stats.ruleNum<<"\n"
+               <<"  alphabet: "<<stats.symbolNum<<" symbols -> "<<stats.classNum<<" classes\n"
+               <<"  NFA: "<<stats.NFAStateNum<<" states, DFA: "<<stats.DFAStateNum
+               <<" states, mDFA: "<<stats.mDFAStateNum<<" states\n"
+               <<"  DFA index: "<<stats.DFAIndexLookups<<" lookups, "
+               <<stats.DFAIndexInserts<<" inserts\n";
+            for(auto phase: {NDFA::NFAPhase, NDFA::DFAPhase, NDFA::mDFAPhase, NDFA::LexerPhase})
+                out<<"  "<<stats.summary(phase)<<"\n";
+            out<<"  "<<stats.arenaSummary()<<"\n";
+        }
+        if(parser.isSet(statsJsonOption))
+        {
+            QJsonObject fileStats=result.cached ? QJsonObject() : stats.toJson();
+            fileStats.insert("file", filePath);
+            fileStats.insert("cached", result.cached);
+            statsArray.append(fileStats);
+        }
+        if(parser.isSet(automatonOption))
+        {
+            QString errorStr;
+            QString imagePath=outDir.filePath(QFileInfo(filePath).completeBaseName()+".r2la");
+            if(!result.imagePath.isEmpty())
+            {
+                //缓存中已有同样的自动机文件，直接复制
+                QFile::remove(imagePath);
+                if(!QFile::copy(result.imagePath, imagePath))
+                {
+                    QTextStream(stderr)<<"文件打开/写入失败: "<<imagePath<<"\n";
+                    failCount++;
+                }
+            }
+            else if(!LexImage::save(ndfa.exportTable(), imagePath, &errorStr))
+            {
+                QTextStream(stderr)<<errorStr<<"\n";
+                failCount++;
+            }
+        }
+        if(parser.isSet(scanOption))
+        {
+            //命中缓存时没有转换结果，映射缓存中的自动机文件分词
+            LexImage image;
+            QString errorStr;
+            if(result.cached && !image.open(result.imagePath, &errorStr))
+            {
+                QTextStream(stderr)<<errorStr<<"\n";
+                failCount++;
+            }
+            else if(!scanFile(result.cached ? LexScanner(image) : LexScanner(ndfa.exportTable()), parser.value(scanOption), outFile))
+                failCount++;
+        }
+    }
+
+    if(cache)
+    {
+        const LexCache::Stats &cacheStats=cache->stats();
+        QTextStream out(outFile);
+        out<<"cache: "<<cacheStats.hits<<" hits, "<<cacheStats.misses<<" misses";
+        if(cacheStats.storeFailures)
+            out<<", "<<cacheStats.storeFailures<<" store failures";
+        out<<"\n";
+    }
+
+    if(parser.isSet(statsJsonOption))
+    {
+        const QByteArray json=QJsonDocument(statsArray).toJson();
+        const QString jsonPath=parser.value(statsJsonOption);
+        if(jsonPath=="-")
+            QTextStream(stdout)<<json;
+        else
+        {
+            QFile jsonFile(jsonPath);
+            if(!jsonFile.open(QIODevice::WriteOnly|QIODevice::Truncate))
+            {
+                QTextStream(stderr)<<"文件打开/写入失败: "<<jsonPath<<"\n";
+                return 1;
+            }
+            jsonFile.write(json);
+            jsonFile.close();
+        }
+    }
+
+    return failCount ? 1 : 0;
+}
@@ -0,0 +1,75 @@
+/****************************************************
+ * @Copyright © 2021-2023 Lyuyk. All rights reserved.
+ *
+ * @FileName: fatablemodel.cpp
+ * @Brief: 状态转换表模型源文件
+ * @Module Function: 单元格内容由NDFA::tableCell按需生成；转换进行中（工作线程修改NDFA时）
+ *                   主窗体先将模型置空，转换结束后再重新设置
+ *
+ * @Current Version: 1.0
+ * @Author: Lyuyk
+ * @Modifier: Lyuyk
+ * @Finished Date: 2026/10/16
+ *
+ * @Version History: 1.0 current version
+ *
+ ****************************************************/
+#include "fatablemodel.h"
+
+FATableModel::FATableModel(NDFA::Phase phase, QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_phase(phase)
+    , m_ndfa(nullptr)
+    , m_rowCount(0)
+    , m_columnCount(0)
+{
+}
+
+/**
+ * @brief FATableModel::setAutomaton
+ * @param ndfa
+ * 重置模型，视图随之重新读取表头与可见的单元格
+ */
+void FATableModel::setAutomaton(const NDFA *ndfa)
+{
+    beginResetModel();
+    m_ndfa=ndfa;
+    m_rowCount=ndfa ? ndfa->tableRowCount(m_phase) : 0;
+    m_columnCount=m_rowCount>0 ? ndfa->tableColumnCount(m_phase) : 0;
+    endResetModel();
+}
+
+int FATableModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_rowCount;
+}
+
+int FATableModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_columnCount;
+}
+
+QVariant FATableModel::data(const QModelIndex &index, int role) const
+{
+    if(!m_ndfa || !index.isValid())
+        return QVariant();
+    if(role==Qt::DisplayRole)
+        return m_ndfa->tableCell(m_phase, index.row(), index.column());
+    if(role==Qt::TextAlignmentRole)
+    {
+        //DFA的NFA状态集列较长，左对齐，其余居中
+        if(m_phase==NDFA::DFAPhase && index.column()==1)
+            return int(Qt::AlignLeft|Qt::AlignVCenter);
+        return int(Qt::AlignCenter);
+    }
+    return QVariant();
+}
+
+QVariant FATableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if(!m_ndfa || role!=Qt::DisplayRole)
+        return QVariant();
+    if(orientation==Qt::Horizontal)
+        return m_ndfa->tableHeader(m_phase, section);
+    return section;
+}
@@ -0,0 +1,45 @@
+/****************************************************
+ * @Copyright © 2021-2023 Lyuyk. All rights reserved.
+ *
+ * @FileName: fatablemodel.h
+ * @Brief: 状态转换表模型头文件
+ * @Module Function: 以QAbstractTableModel包装NDFA的NFA/DFA/最小化DFA状态转换表，
+ *                   视图只对可见的单元格向模型取数据，显示开销与自动机规模无关
+ *
+ * @Current Version: 1.0
+ * @Author: Lyuyk
+ * @Modifier: Lyuyk
+ * @Finished Date: 2026/10/16
+ *
+ * @Version History: 1.0 current version
+ *
+ ****************************************************/
+#ifndef FATABLEMODEL_H
+#define FATABLEMODEL_H
+
+#include <QAbstractTableModel>
+
+#include "ndfa.h"
+
+class FATableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit FATableModel(NDFA::Phase phase, QObject *parent = nullptr);//phase为NFAPhase、DFAPhase或mDFAPhase
+
+    void setAutomaton(const NDFA *ndfa);//显示ndfa中的自动机，为空则清空表格；自动机改变后须重新设置
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    NDFA::Phase m_phase;
+    const NDFA *m_ndfa;
+    int m_rowCount;//设置自动机时记下的行列数
+    int m_columnCount;
+};
+
+#endif // FATABLEMODEL_H
@@ -0,0 +1,317 @@
+/****************************************************
+ * @Copyright © 2021-2023 Lyuyk. All rights reserved.
+ *
+ * @FileName: lazydfa.cpp
+ * @Brief: 惰性DFA源文件
+ * @Module Function: 按需子集构造，转换结果缓存在固定内存上限内
+ *
+ * @Current Version: 1.0
+ * @Author: Lyuyk
+ * @Modifier: Lyuyk
+ * @Finished Date: 2026/10/16
+ *
+ * @Version History: 1.0 current version
+ *
+ ****************************************************/
+#include "lazydfa.h"
+
+#include<algorithm>
+
+LazyDFA::LazyDFA(const LexNFA &nfa, qsizetype memoryBudget)
+    : m_nfa(nfa), m_budget(memoryBudget)
+{
+    //转换表一行 + 状态集（缓存与索引各一份）+ 容器开销的估计
+    m_stateBytes=qsizetype(sizeof(int))*(m_nfa.classNum+1)
+            +2*((m_nfa.stateNum+63)/64)*qsizetype(sizeof(quint64))
+            +64;
+    m_stats={0, 0, 0, 0};
+
+    //与LexScanner一致：多规则模式下沿用Keyword规则，单条正则表达式模式下追加一条
+    for(const auto &keyword: m_nfa.keywords)
+        m_keywords.append(keyword.toUtf8());
+    std::sort(m_keywords.begin(),m_keywords.end());
+    if(!m_keywords.isEmpty())
+    {
+        m_keywordRule=m_nfa.ruleNames.indexOf("Keyword");
+        if(m_keywordRule<0)
+        {
+            m_keywordRule=m_nfa.ruleNames.size();
+            m_nfa.ruleNames.append("Keyword");
+            m_nfa.ruleSkip.append(false);
+        }
+    }
+}
+
+const LexNFA &LazyDFA::nfa() const
+{
+    return m_nfa;
+}
+
+int LazyDFA::ruleNum() const
+{
+    return m_nfa.ruleNames.size();
+}
+
+QString LazyDFA::ruleName(int rule) const
+{
+    return rule>=0 ? m_nfa.ruleNames.value(rule) : QString("Error");
+}
+
+void LazyDFA::setSkipWhitespace(bool skip)
+{
+    this->m_skipWhitespace=skip;
+}
+
+const LazyDFA::CacheStats &LazyDFA::cacheStats() const
+{
+    return m_stats;
+}
+
+qsizetype LazyDFA::memoryUsed() const
+{
+    return m_sets.size()*m_stateBytes;
+}
+
+/**
+ * @brief LazyDFA::clearCache
+ * 清空所有已求出的状态与转换
+ */
+void LazyDFA::clearCache()
+{
+    m_sets.clear();
+    m_index.clear();
+    m_trans.clear();
+    m_accept.clear();
+    m_start=-1;
+}
+
+/**
+ * @brief LazyDFA::closure
+ * @param set
+ * 求epsilon闭包
+ */
+void LazyDFA::closure(StateSet &set) const
+{
+    QList<int> stack=set.values();
+    while(!stack.empty())
+    {
+        int s=stack.takeLast();
+        for(int i=m_nfa.epsOff[s];i<m_nfa.epsOff[s+1];i++)
+        {
+            int t=m_nfa.epsTo[i];
+            if(!set.contains(t))
+            {
+                set.insert(t);
+                stack.append(t);
+            }
+        }
+    }
+}
+
+/**
+ * @brief LazyDFA::move
+ * @param set
+ * @param cls
+ * @param target
+ * 求状态集经字符类cls到达的状态集的epsilon闭包
+ */
+void LazyDFA::move(const StateSet &set, int cls, StateSet &target) const
+{
+    target=StateSet(m_nfa.stateNum);
+    for(int s: set)
+    {
+        if(m_nfa.toState[s]<0)
+            continue;
+        for(int i=m_nfa.edgeOff[s];i<m_nfa.edgeOff[s+1];i++)
+            if(m_nfa.edgeClasses[i]==cls)
+            {
+                target.insert(m_nfa.toState[s]);
+                break;
+            }
+    }
+    closure(target);
+}
+
+bool LazyDFA::isKeyword(const char *data, qsizetype len) const
+{
+    return std::binary_search(m_keywords.begin(),m_keywords.end(),QByteArray::fromRawData(data, len));
+}
+
+/**
+ * @brief LazyDFA::addState
+ * @param set
+ * @return 新DFA状态号
+ */
+int LazyDFA::addState(const StateSet &set)
+{
+    int id=m_sets.size();
+    m_sets.append(set);
+    m_index.insert(set, id);
+    m_trans.resize(m_trans.size()+m_nfa.classNum, Unknown);
+
+    int accept=-1;
+    for(const auto &state: m_nfa.acceptStates)
+        if(set.contains(state))
+        {
+            accept=m_nfa.acceptRule[state];
+            break;
+        }
+    m_accept.append(accept);
+    m_stats.statesBuilt++;
+    return id;
+}
+
+int LazyDFA::startState()
+{
+    if(m_start<0)
+    {
+        StateSet set(m_nfa.stateNum);
+        set.insert(m_nfa.startState);
+        closure(set);
+        auto it=m_index.constFind(set);
+        m_start=it!=m_index.constEnd() ? it.value() : addState(set);
+    }
+    return m_start;
+}
+
+/**
+ * @brief LazyDFA::step
+ * @param state
+ * @param cls
+ * @return 下一DFA状态号，无此边时为-1
+ * 转换已缓存时直接返回；否则求出目标状态集，与缓存中已有的状态合并。
+ * 缓存超出上限时先清空，只保留当前状态，再继续求转换；
+ * 没有显式边的字符类改走“~”边，与导出的转换表一致
+ */
+int LazyDFA::step(int &state, int cls)
+{
+    int t=m_trans[state*m_nfa.classNum+cls];
+    if(t!=Unknown)
+    {
+        m_stats.transHits++;
+        return t;
+    }
+    m_stats.transMisses++;
+
+    StateSet target;
+    move(m_sets[state], cls, target);
+    if(target.isEmpty() && cls!=m_nfa.otherClass)
+        move(m_sets[state], m_nfa.otherClass, target);
+    if(target.isEmpty())
+    {
+        m_trans[state*m_nfa.classNum+cls]=-1;
+        return -1;
+    }
+
+    auto it=m_index.constFind(target);
+    if(it!=m_index.constEnd())
+        t=it.value();
+    else
+    {
+        if(memoryUsed()+m_stateBytes>m_budget)
+        {
+            StateSet cur=m_sets[state];
+            clearCache();
+            m_stats.cacheFlushes++;
+            state=addState(cur);
+            t=(target==cur) ? state : addState(target);//自环时不能为同一集合建两个状态
+        }
+        else
+            t=addState(target);
+    }
+    m_trans[state*m_nfa.classNum+cls]=t;
+    return t;
+}
+
+bool LazyDFA::match(const char *data, qsizetype len, int *rule)
+{
+    if(!m_nfa.isValid())
+        return false;
+    int state=startState();
+    for(qsizetype i=0;i<len;i++)
+    {
+        state=step(state, m_nfa.byteClass[uchar(data[i])]);
+        if(state<0)
+            return false;
+    }
+    int accept=m_accept[state];
+    if(accept>=0 && m_keywordRule>=0 && isKeyword(data, len))
+        accept=m_keywordRule;
+    if(rule)
+        *rule=accept;
+    return accept>=0;
+}
+
+bool LazyDFA::match(const QByteArray &data, int *rule)
+{
+    return match(data.constData(), data.size(), rule);
+}
+
+qsizetype LazyDFA::scanPrefix(const char *data, qsizetype len, int *rule)
+{
+    if(!m_nfa.isValid())
+        return -1;
+    int state=startState();
+    qsizetype lastLen=-1;
+    int lastRule=-1;
+    for(qsizetype i=0;i<len;i++)
+    {
+        state=step(state, m_nfa.byteClass[uchar(data[i])]);
+        if(state<0)
+            break;
+        if(m_accept[state]>=0)
+        {
+            lastLen=i+1;
+            lastRule=m_accept[state];
+        }
+    }
+    if(lastLen>0 && m_keywordRule>=0 && isKeyword(data, lastLen))
+        lastRule=m_keywordRule;
+    if(rule)
+        *rule=lastRule;
+    return lastLen;
+}
+
+qsizetype LazyDFA::scanPrefix(const QByteArray &data, int *rule)
+{
+    return scanPrefix(data.constData(), data.size(), rule);
+}
+
+/**
+ * @brief LazyDFA::tokenize
+ * 与LexScanner::tokenize相同：反复取最长匹配前缀，无法识别的字节以规则号-1报告
+ */
+qsizetype LazyDFA::tokenize(const char *data, qsizetype len, const LexScanner::TokenCallback &callback)
+{
+    qsizetype pos=0;
+    while(pos<len)
+    {
+        char ch=data[pos];
+        if(m_skipWhitespace && (ch==' ' || ch=='\n' || ch=='\t'))
+        {
+            pos++;
+            continue;
+        }
+
+        LexScanner::Token token;
+        token.offset=pos;
+        token.length=scanPrefix(data+pos, len-pos, &token.rule);
+        if(token.length<=0)
+        {
+            token.rule=-1;
+            token.length=1;
+        }
+        pos+=token.length;
+
+        if(token.rule>=0 && m_nfa.ruleSkip.value(token.rule))
+            continue;
+        if(!callback(token))
+            return pos;
+    }
+    return pos;
+}
+
+qsizetype LazyDFA::tokenize(const QByteArray &data, const LexScanner::TokenCallback &callback)
+{
+    return tokenize(data.constData(), data.size(), callback);
+}
@@ -0,0 +1,106 @@
+/****************************************************
+ * @Copyright © 2021-2023 Lyuyk. All rights reserved.
+ *
+ * @FileName: lazydfa.h
+ * @Brief: 惰性DFA头文件
+ * @Module Function: 不预先确定化NFA，扫描输入时按需求出DFA状态与转换，
+ *                   并缓存在给定的内存上限内，缓存满时清空重建
+ *
+ * @Current Version: 1.0
+ * @Author: Lyuyk
+ * @Modifier: Lyuyk
+ * @Finished Date: 2026/10/16
+ *
+ * @Version History: 1.0 current version
+ *
+ ****************************************************/
+#ifndef LAZYDFA_H
+#define LAZYDFA_H
+
+#include<QByteArray>
+#include<QHash>
+#include<QList>
+#include<QStringList>
+
+#include "lexscanner.h"
+#include "stateset.h"
+
+//由NDFA::exportNFA导出的NFA（边已换算为字符类号），与NDFA对象无关
+struct LexNFA
+{
+    int stateNum=0;//NFA状态数
+    int startState=-1;//初态
+    int classNum=0;//字符类数
+    int otherClass=-1;//“~”边所在的字符类
+    QList<int> byteClass;//字节(0~255)→字符类号
+    QList<int> toState;//状态→非epsilon边的目标，-1为无
+    QList<int> edgeOff, edgeClasses;//状态s的非epsilon边覆盖的字符类为 edgeClasses[edgeOff[s] .. edgeOff[s+1])
+    QList<int> epsOff, epsTo;//状态s的epsilon边目标为 epsTo[epsOff[s] .. epsOff[s+1])
+    QList<int> acceptStates;//各规则的终态，按优先级排列
+    QList<int> acceptRule;//状态→规则号，-1为非终态
+    QStringList ruleNames;//规则号→单词类别名
+    QList<bool> ruleSkip;//规则号→分词时是否跳过
+    QStringList keywords;//关键字表，与LexTable::keywords相同
+
+    bool isValid() const { return startState>=0; }
+};
+
+class LazyDFA
+{
+public:
+    //缓存统计
+    struct CacheStats
+    {
+        qint64 transHits;//已缓存的转换
+        qint64 transMisses;//需现场求出的转换
+        qint64 statesBuilt;//求出的DFA状态数（含清空后重建的）
+        qint64 cacheFlushes;//缓存清空次数
+    };
+
+public:
+    explicit LazyDFA(const LexNFA &nfa, qsizetype memoryBudget=1<<20);
+
+    const LexNFA &nfa() const;
+    int ruleNum() const;//有关键字表而规则中没有Keyword时，末尾追加一条Keyword规则
+    QString ruleName(int rule) const;//规则号→单词类别名，-1为Error
+    void setSkipWhitespace(bool skip);//分词时是否跳过空格、换行、制表符（默认跳过）
+    const CacheStats &cacheStats() const;
+    qsizetype memoryUsed() const;//当前缓存估计占用的字节数
+    void clearCache();
+
+    //与LexScanner相同的接口与语义（最长匹配，匹配恰为关键字时归为Keyword）
+    bool match(const char *data, qsizetype len, int *rule=nullptr);
+    bool match(const QByteArray &data, int *rule=nullptr);
+    qsizetype scanPrefix(const char *data, qsizetype len, int *rule=nullptr);
+    qsizetype scanPrefix(const QByteArray &data, int *rule=nullptr);
+    qsizetype tokenize(const char *data, qsizetype len, const LexScanner::TokenCallback &callback);
+    qsizetype tokenize(const QByteArray &data, const LexScanner::TokenCallback &callback);
+
+private:
+    int startState();//缓存中的初态，不存在时求出
+    int step(int &state, int cls);//状态state经字符类cls的转换，缓存满而清空时state被改为重建后的编号
+    int addState(const StateSet &set);//将NFA状态集加入缓存，返回DFA状态号
+    void move(const StateSet &set, int cls, StateSet &target) const;//move+closure
+    void closure(StateSet &set) const;//epsilon闭包
+    bool isKeyword(const char *data, qsizetype len) const;
+
+private:
+    static constexpr int Unknown=-2;//转换尚未求出
+
+    LexNFA m_nfa;
+    qsizetype m_budget;//缓存内存上限（字节）
+    qsizetype m_stateBytes;//每个DFA状态估计占用的字节数
+    bool m_skipWhitespace=true;
+    QList<QByteArray> m_keywords;//关键字表（按字节序排序）
+    int m_keywordRule=-1;//关键字归入的规则号，无关键字时为-1
+
+    QList<StateSet> m_sets;//DFA状态→NFA状态集
+    QHash<StateSet, int> m_index;//NFA状态集→DFA状态号
+    QList<int> m_trans;//转换缓存 m_trans[s*classNum+c]，Unknown为未求出，-1为无此边
+    QList<int> m_accept;//DFA状态→接受的规则号
+    int m_start=-1;//初态在缓存中的编号
+
+    CacheStats m_stats;
+};
+
+#endif // LAZYDFA_H
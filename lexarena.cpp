@@ -0,0 +1,95 @@
+/****************************************************
+ * @Copyright © 2021-2023 Lyuyk. All rights reserved.
+ *
+ * @FileName: lexarena.cpp
+ * @Brief: 编译内存池源文件
+ * @Module Function: 分级回收池（unsynchronized_pool_resource）建于单调缓冲区
+ *                   （monotonic_buffer_resource）之上，单调缓冲区向系统申请的块由BlockSource计数；
+ *                   单调缓冲区不回收释放的内存，故超过分级上限的大块绕过池与单调缓冲区，直接使用全局new/delete
+ *
+ * @Current Version: 1.0
+ * @Author: Lyuyk
+ * @Modifier: Lyuyk
+ * @Finished Date: 2026/10/16
+ *
+ * @Version History: 1.0 current version
+ *
+ ****************************************************/
+#include "lexarena.h"
+
+LexArena::LexArena()
+    : m_stats{0, 0, 0, 0}
+    , m_blockSource(&m_stats)
+    , m_buffer(InitialBlockSize, &m_blockSource)
+    , m_pool(std::pmr::pool_options{0, LargestPoolBlock}, &m_buffer)
+{
+}
+
+/**
+ * @brief LexArena::release
+ * 先让回收池把块交还单调缓冲区，再由单调缓冲区把全部内存块交还系统
+ */
+void LexArena::release()
+{
+    m_pool.release();
+    m_buffer.release();
+    m_stats={0, 0, 0, 0};
+}
+
+const LexArena::Stats &LexArena::stats() const
+{
+    return m_stats;
+}
+
+void *LexArena::do_allocate(size_t bytes, size_t alignment)
+{
+    m_stats.allocations++;
+    m_stats.bytes+=bytes;
+    if(bytes>LargestPoolBlock)
+    {
+        m_stats.blocks++;
+        m_stats.blockBytes+=bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    return m_pool.allocate(bytes, alignment);
+}
+
+/**
+ * @brief LexArena::do_deallocate
+ * 大块按分配时的大小同样判断，立即归还系统；小块交回池中复用
+ */
+void LexArena::do_deallocate(void *p, size_t bytes, size_t alignment)
+{
+    if(bytes>LargestPoolBlock)
+    {
+        m_stats.blocks--;
+        m_stats.blockBytes-=bytes;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        return;
+    }
+    m_pool.deallocate(p, bytes, alignment);
+}
+
+bool LexArena::do_is_equal(const std::pmr::memory_resource &other) const noexcept
+{
+    return this==&other;
+}
+
+void *LexArena::BlockSource::do_allocate(size_t bytes, size_t alignment)
+{
+    m_stats->blocks++;
+    m_stats->blockBytes+=bytes;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+}
+
+void LexArena::BlockSource::do_deallocate(void *p, size_t bytes, size_t alignment)
+{
+    m_stats->blocks--;
+    m_stats->blockBytes-=bytes;
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+}
+
+bool LexArena::BlockSource::do_is_equal(const std::pmr::memory_resource &other) const noexcept
+{
+    return this==&other;
+}
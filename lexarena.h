@@ -0,0 +1,112 @@
+/****************************************************
+ * @Copyright © 2021-2023 Lyuyk. All rights reserved.
+ *
+ * @FileName: lexarena.h
+ * @Brief: 编译内存池头文件
+ * @Module Function: 一次编译（reg2NFA/rules2NFA→NFA2DFA→DFA2mDFA）中的状态集位图、
+ *                   构造用的栈与划分数组都从同一个内存池分配：小块由池向系统按块申请，
+ *                   编译中途释放后按大小分级回收复用，NDFA::init时整体归还；
+ *                   超过分级上限的大块直接向系统申请、释放时立即归还，反复确定化/最小化不会累积；
+ *                   并统计分配次数与当前占用的系统内存
+ *
+ * @Current Version: 1.0
+ * @Author: Lyuyk
+ * @Modifier: Lyuyk
+ * @Finished Date: 2026/10/16
+ *
+ * @Version History: 1.0 current version
+ *
+ ****************************************************/
+#ifndef LEXARENA_H
+#define LEXARENA_H
+
+#include<QtGlobal>
+
+#include<memory_resource>
+#include<type_traits>
+#include<vector>
+
+class LexArena : public std::pmr::memory_resource
+{
+public:
+    //自上次release以来的分配统计
+    struct Stats
+    {
+        qint64 allocations;//分配的次数（含绕过池的大块，下同）
+        qint64 bytes;//分配的字节数（累计）
+        qint64 blocks;//当前占用的系统内存块数（池的块与尚未释放的大块）
+        qint64 blockBytes;//当前占用的系统内存字节数
+    };
+
+public:
+    LexArena();
+    LexArena(const LexArena &)=delete;
+    LexArena &operator=(const LexArena &)=delete;
+
+    void release();//一次性归还全部内存并清零统计；调用前从池中分配的对象须已全部析构
+    const Stats &stats() const;
+
+protected:
+    void *do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+private:
+    //单调缓冲区的上游：向系统申请内存块并计数，块在release时才归还
+    class BlockSource : public std::pmr::memory_resource
+    {
+    public:
+        explicit BlockSource(Stats *stats) : m_stats(stats) {}
+
+    protected:
+        void *do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void *p, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+    private:
+        Stats *m_stats;
+    };
+
+    static const size_t InitialBlockSize=64*1024;//单调缓冲区的第一块，之后按几何级数增长
+    static const size_t LargestPoolBlock=64*1024;//按大小分级回收的上限，更大的块不经过池
+
+    Stats m_stats;
+    BlockSource m_blockSource;
+    std::pmr::monotonic_buffer_resource m_buffer;//只增不减，release时整体归还
+    std::pmr::unsynchronized_pool_resource m_pool;//建于m_buffer之上，回收编译中途释放的小块；只供一个线程使用
+};
+
+//从LexArena（或其他memory_resource）分配的分配器，为空时使用全局new/delete。
+//赋值与交换时分配器随内容一起转移，故容器赋值后总是使用源容器的内存池，
+//对象可以安全地在池内外的容器之间赋值
+template<class T>
+class ArenaAllocator
+{
+public:
+    using value_type=T;
+    using propagate_on_container_copy_assignment=std::true_type;
+    using propagate_on_container_move_assignment=std::true_type;
+    using propagate_on_container_swap=std::true_type;
+
+    ArenaAllocator(std::pmr::memory_resource *resource=nullptr)
+        : m_resource(resource ? resource : std::pmr::new_delete_resource()) {}
+    template<class U>
+    ArenaAllocator(const ArenaAllocator<U> &other) : m_resource(other.resource()) {}
+
+    T *allocate(size_t n) { return static_cast<T *>(m_resource->allocate(n*sizeof(T), alignof(T))); }
+    void deallocate(T *p, size_t n) { m_resource->deallocate(p, n*sizeof(T), alignof(T)); }
+    std::pmr::memory_resource *resource() const { return m_resource; }
+
+    template<class U>
+    bool operator==(const ArenaAllocator<U> &other) const { return *m_resource==*other.resource(); }
+    template<class U>
+    bool operator!=(const ArenaAllocator<U> &other) const { return !(*this==other); }
+
+private:
+    std::pmr::memory_resource *m_resource;
+};
+
+template<class T>
+using ArenaVector=std::vector<T, ArenaAllocator<T>>;
+
+#endif // LEXARENA_H
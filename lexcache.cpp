@@ -0,0 +1,128 @@
+/****************************************************
+ * @Copyright © 2021-2023 Lyuyk. All rights reserved.
+ *
+ * @FileName: lexcache.cpp
+ * @Brief: 编译结果磁盘缓存源文件
+ * @Module Function: 每个键对应 <键>.r2la（自动机文件）与 <键>.c（生成的代码）两个文件，
+ *                   先写自动机再写代码，以代码文件的存在作为缓存项完整的标志
+ *
+ * @Current Version: 1.0
+ * @Author: Lyuyk
+ * @Modifier: Lyuyk
+ * @Finished Date: 2026/10/16
+ *
+ * @Version History: 1.0 current version
+ *
+ ****************************************************/
+#include "lexcache.h"
+#include "leximage.h"
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QSaveFile>
+
+LexCache::LexCache(const QString &dirPath)
+    : m_dir(dirPath)
+{
+    m_valid=m_dir.exists() || m_dir.mkpath(".");
+    m_stats={0, 0, 0, 0};
+}
+
+bool LexCache::isValid() const
+{
+    return m_valid;
+}
+
+QString LexCache::dirPath() const
+{
+    return m_dir.path();
+}
+
+const LexCache::Stats &LexCache::stats() const
+{
+    return m_stats;
+}
+
+/**
+ * @brief LexCache::key
+ * @param ruleLines 参与编译的规则文本（单条正则表达式时为正则表达式行与关键字行）
+ * @param options 影响生成结果的选项，如生成方式、输出目录
+ * @return 十六进制SHA-256
+ * 各项以长度前缀拼接后求哈希，避免不同的切分得到相同的串；
+ * 缓存格式与自动机文件版本也计入键中
+ */
+QByteArray LexCache::key(const QStringList &ruleLines, const QStringList &options)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    auto addField=[&hash](const QString &field){
+        const QByteArray bytes=field.toUtf8();
+        hash.addData(QByteArray::number(bytes.size())+":");
+        hash.addData(bytes);
+    };
+    addField(QString("r2lexer-cache %1 image %2").arg(FormatVersion).arg(LexImage::Version));
+    addField(QString::number(ruleLines.size()));
+    for(const auto &line: ruleLines)
+        addField(line);
+    addField(QString::number(options.size()));
+    for(const auto &option: options)
+        addField(option);
+    return hash.result().toHex();
+}
+
+QString LexCache::codePath(const QByteArray &key) const
+{
+    return m_dir.filePath(QString::fromLatin1(key)+".c");
+}
+
+QString LexCache::automatonPath(const QByteArray &key) const
+{
+    return m_dir.filePath(QString::fromLatin1(key)+".r2la");
+}
+
+/**
+ * @brief LexCache::lookup
+ * @param key
+ * @param lexCode
+ * @return 是否命中
+ * 代码文件与自动机文件都存在才算命中
+ */
+bool LexCache::lookup(const QByteArray &key, QString &lexCode)
+{
+    if(m_valid && QFile::exists(automatonPath(key)))
+    {
+        QFile codeFile(codePath(key));
+        if(codeFile.open(QIODevice::ReadOnly))
+        {
+            lexCode=QString::fromUtf8(codeFile.readAll());
+            codeFile.close();
+            m_stats.hits++;
+            return true;
+        }
+    }
+    m_stats.misses++;
+    return false;
+}
+
+/**
+ * @brief LexCache::store
+ * @param key
+ * @param lexCode
+ * @param table
+ * @return 是否写入成功
+ * 两个文件均经QSaveFile写临时文件后改名；并发写入同一键时内容相同，后写者覆盖即可
+ */
+bool LexCache::store(const QByteArray &key, const QString &lexCode, const LexTable &table)
+{
+    bool ok=m_valid && LexImage::save(table, automatonPath(key));
+    if(ok)
+    {
+        QSaveFile codeFile(codePath(key));
+        const QByteArray code=lexCode.toUtf8();
+        ok=codeFile.open(QIODevice::WriteOnly) && codeFile.write(code)==code.size() && codeFile.commit();
+    }
+    if(ok)
+        m_stats.stores++;
+    else
+        m_stats.storeFailures++;
+    return ok;
+}
@@ -0,0 +1,61 @@
+/****************************************************
+ * @Copyright © 2021-2023 Lyuyk. All rights reserved.
+ *
+ * @FileName: lexcache.h
+ * @Brief: 编译结果磁盘缓存头文件
+ * @Module Function: 以规则文本与生成选项的SHA-256为键，在本地目录中保存
+ *                   生成的词法分析程序代码与自动机文件；命中时跳过全部转换。
+ *                   写入经临时文件改名完成，多个进程同时使用同一目录也不会读到不完整的文件
+ *
+ * @Current Version: 1.0
+ * @Author: Lyuyk
+ * @Modifier: Lyuyk
+ * @Finished Date: 2026/10/16
+ *
+ * @Version History: 1.0 current version
+ *
+ ****************************************************/
+#ifndef LEXCACHE_H
+#define LEXCACHE_H
+
+#include<QByteArray>
+#include<QDir>
+#include<QString>
+#include<QStringList>
+
+#include "lexscanner.h"
+
+class LexCache
+{
+public:
+    //本次运行的缓存统计
+    struct Stats
+    {
+        int hits;//命中次数
+        int misses;//未命中次数
+        int stores;//写入缓存的次数
+        int storeFailures;//写入失败的次数（不影响编译结果）
+    };
+
+public:
+    explicit LexCache(const QString &dirPath);
+
+    bool isValid() const;//缓存目录是否可用
+    QString dirPath() const;
+    const Stats &stats() const;
+
+    static QByteArray key(const QStringList &ruleLines, const QStringList &options);//缓存键（十六进制SHA-256）
+    bool lookup(const QByteArray &key, QString &lexCode);//命中时取出生成的代码，并计入统计
+    bool store(const QByteArray &key, const QString &lexCode, const LexTable &table);//保存代码与自动机文件
+    QString codePath(const QByteArray &key) const;
+    QString automatonPath(const QByteArray &key) const;
+
+private:
+    static const int FormatVersion=1;//缓存内容格式，变化时旧缓存自然失效
+
+    QDir m_dir;
+    bool m_valid;
+    Stats m_stats;
+};
+
+#endif // LEXCACHE_H
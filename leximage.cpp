@@ -0,0 +1,298 @@
+/****************************************************
+ * @Copyright © 2021-2023 Lyuyk. All rights reserved.
+ *
+ * @FileName: leximage.cpp
+ * @Brief: 编译好的最小化DFA的二进制文件源文件
+ * @Module Function: 写入与内存映射加载，加载时只做边界与取值范围校验
+ *
+ * @Current Version: 1.0
+ * @Author: Lyuyk
+ * @Modifier: Lyuyk
+ * @Finished Date: 2026/10/16
+ *
+ * @Version History: 1.0 current version
+ *
+ ****************************************************/
+#include "leximage.h"
+
+#include <QSaveFile>
+
+#include <algorithm>
+#include <cstring>
+
+LexImage::LexImage()
+{
+}
+
+LexImage::~LexImage()
+{
+    close();
+}
+
+/**
+ * @brief LexImage::save
+ * @param table
+ * @param filePath
+ * @param errorStr
+ * @return 是否写入成功
+ * 按文件布局依次写出各段；经QSaveFile写入，失败时不会留下不完整的文件
+ */
+bool LexImage::save(const LexTable &table, const QString &filePath, QString *errorStr)
+{
+    if(!table.isValid() || table.byteClass.size()!=256)
+    {
+        if(errorStr)*errorStr="最小化DFA为空";
+        return false;
+    }
+
+    //字符串区：规则名在前，关键字按字节序排序在后
+    QByteArray strings;
+    QList<quint32> ruleNameOff, keywordOff;
+    ruleNameOff.append(0);
+    for(const auto &name: table.ruleNames)
+    {
+        strings.append(name.toUtf8());
+        ruleNameOff.append(strings.size());
+    }
+    QList<QByteArray> keywords;
+    for(const auto &keyword: table.keywords)
+        keywords.append(keyword.toUtf8());
+    std::sort(keywords.begin(),keywords.end());
+    keywords.erase(std::unique(keywords.begin(),keywords.end()),keywords.end());
+    keywordOff.append(strings.size());
+    for(const auto &keyword: keywords)
+    {
+        strings.append(keyword);
+        keywordOff.append(strings.size());
+    }
+
+    const int ruleNum=table.ruleNames.size();
+    Header header;
+    memset(&header, 0, sizeof(header));
+    header.magic=Magic;
+    header.version=Version;
+    header.headerSize=sizeof(Header);
+    header.stateNum=table.stateNum;
+    header.classNum=table.classNum;
+    header.startState=table.startState;
+    header.ruleNum=ruleNum;
+    header.keywordNum=keywords.size();
+    quint32 off=sizeof(Header);
+    header.byteClassOff=off;  off+=256*sizeof(qint32);
+    header.transOff=off;      off+=quint32(table.trans.size())*sizeof(qint32);
+    header.acceptOff=off;     off+=quint32(table.accept.size())*sizeof(qint32);
+    header.ruleSkipOff=off;   off+=quint32(ruleNum)*sizeof(qint32);
+    header.ruleNameOff=off;   off+=quint32(ruleNameOff.size())*sizeof(quint32);
+    header.keywordOff=off;    off+=quint32(keywordOff.size())*sizeof(quint32);
+    header.stringOff=off;     off+=strings.size();
+    header.stringSize=strings.size();
+    header.fileSize=(off+3)&~3u;
+
+    QByteArray image;
+    image.reserve(header.fileSize);
+    auto appendInts=[&image](const auto &list){
+        for(const auto &v: list)
+        {
+            qint32 x=v;
+            image.append(reinterpret_cast<const char *>(&x), sizeof(x));
+        }
+    };
+    image.append(reinterpret_cast<const char *>(&header), sizeof(header));
+    appendInts(table.byteClass);
+    appendInts(table.trans);
+    appendInts(table.accept);
+    for(int i=0;i<ruleNum;i++)
+    {
+        qint32 skip=table.ruleSkip.value(i) ? 1 : 0;
+        image.append(reinterpret_cast<const char *>(&skip), sizeof(skip));
+    }
+    appendInts(ruleNameOff);
+    appendInts(keywordOff);
+    image.append(strings);
+    image.append(QByteArray(header.fileSize-image.size(), '\0'));
+
+    QSaveFile file(filePath);
+    if(!file.open(QIODevice::WriteOnly) || file.write(image)!=image.size() || !file.commit())
+    {
+        if(errorStr)*errorStr="文件打开/写入失败: "+filePath;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief LexImage::open
+ * @param filePath
+ * @param errorStr
+ * @return 是否加载成功
+ * 映射整个文件，校验文件头、各段边界与表中的状态号、字符类号范围，
+ * 之后的访问都直接读映射内存
+ */
+bool LexImage::open(const QString &filePath, QString *errorStr)
+{
+    close();
+    auto fail=[&](const QString &msg){
+        if(errorStr)*errorStr=filePath+": "+msg;
+        close();
+        return false;
+    };
+
+    m_file.setFileName(filePath);
+    if(!m_file.open(QIODevice::ReadOnly))
+        return fail("无法打开文件");
+    const qint64 fileSize=m_file.size();
+    if(fileSize<qint64(sizeof(Header)))
+        return fail("文件过短");
+    m_data=m_file.map(0, fileSize);
+    if(!m_data)
+        return fail("内存映射失败");
+    m_header=reinterpret_cast<const Header *>(m_data);
+
+    const Header &h=*m_header;
+    if(h.magic!=Magic)
+        return fail("不是自动机文件，或字节序不同");
+    if(h.version!=Version)
+        return fail("不支持的版本 "+QString::number(h.version));
+    if(h.headerSize<sizeof(Header) || h.fileSize!=fileSize)
+        return fail("文件头与文件大小不符");
+    if(h.stateNum<=0 || h.classNum<=0 || h.startState<0 || h.startState>=h.stateNum
+            || h.ruleNum<0 || h.keywordNum<0)
+        return fail("文件头数据无效");
+
+    //各段须在文件内且4字节对齐
+    auto sectionOk=[&](quint32 off, qint64 bytes){
+        return off%4==0 && bytes>=0 && off>=h.headerSize && qint64(off)+bytes<=fileSize;
+    };
+    if(!sectionOk(h.byteClassOff, 256*4) || !sectionOk(h.transOff, qint64(h.stateNum)*h.classNum*4)
+            || !sectionOk(h.acceptOff, qint64(h.stateNum)*4) || !sectionOk(h.ruleSkipOff, qint64(h.ruleNum)*4)
+            || !sectionOk(h.ruleNameOff, (qint64(h.ruleNum)+1)*4) || !sectionOk(h.keywordOff, (qint64(h.keywordNum)+1)*4)
+            || qint64(h.stringOff)+h.stringSize>fileSize)
+        return fail("段越界");
+
+    //扫描时不再检查下标，故此处校验表中所有取值
+    for(int b=0;b<256;b++)
+        if(byteClass()[b]<0 || byteClass()[b]>=h.classNum)
+            return fail("字符类号越界");
+    const qint32 *t=trans();
+    for(qint64 i=0;i<qint64(h.stateNum)*h.classNum;i++)
+        if(t[i]<-1 || t[i]>=h.stateNum)
+            return fail("状态号越界");
+    for(int s=0;s<h.stateNum;s++)
+        if(accept()[s]<-1 || accept()[s]>=h.ruleNum)
+            return fail("规则号越界");
+    auto stringsOk=[&](quint32 offsetsOff, int n){
+        const quint32 *o=reinterpret_cast<const quint32 *>(m_data+offsetsOff);
+        for(int i=0;i<n;i++)
+            if(o[i]>o[i+1] || o[i+1]>h.stringSize)
+                return false;
+        return true;
+    };
+    if(!stringsOk(h.ruleNameOff, h.ruleNum) || !stringsOk(h.keywordOff, h.keywordNum))
+        return fail("字符串区越界");
+    return true;
+}
+
+void LexImage::close()
+{
+    if(m_data)
+        m_file.unmap(const_cast<uchar *>(m_data));
+    m_data=nullptr;
+    m_header=nullptr;
+    if(m_file.isOpen())
+        m_file.close();
+}
+
+bool LexImage::isOpen() const
+{
+    return m_data!=nullptr;
+}
+
+int LexImage::stateNum() const
+{
+    return m_header->stateNum;
+}
+
+int LexImage::classNum() const
+{
+    return m_header->classNum;
+}
+
+int LexImage::startState() const
+{
+    return m_header->startState;
+}
+
+int LexImage::ruleNum() const
+{
+    return m_header->ruleNum;
+}
+
+const qint32 *LexImage::byteClass() const
+{
+    return reinterpret_cast<const qint32 *>(m_data+m_header->byteClassOff);
+}
+
+const qint32 *LexImage::trans() const
+{
+    return reinterpret_cast<const qint32 *>(m_data+m_header->transOff);
+}
+
+const qint32 *LexImage::accept() const
+{
+    return reinterpret_cast<const qint32 *>(m_data+m_header->acceptOff);
+}
+
+bool LexImage::ruleSkip(int rule) const
+{
+    if(rule<0 || rule>=m_header->ruleNum)
+        return false;
+    return reinterpret_cast<const qint32 *>(m_data+m_header->ruleSkipOff)[rule]!=0;
+}
+
+QByteArray LexImage::string(const quint32 *offsets, int i) const
+{
+    const char *strings=reinterpret_cast<const char *>(m_data+m_header->stringOff);
+    return QByteArray::fromRawData(strings+offsets[i], offsets[i+1]-offsets[i]);
+}
+
+QString LexImage::ruleName(int rule) const
+{
+    if(rule<0 || rule>=m_header->ruleNum)
+        return QString();
+    return QString::fromUtf8(string(reinterpret_cast<const quint32 *>(m_data+m_header->ruleNameOff), rule));
+}
+
+int LexImage::keywordNum() const
+{
+    return m_header->keywordNum;
+}
+
+QByteArray LexImage::keyword(int i) const
+{
+    return string(reinterpret_cast<const quint32 *>(m_data+m_header->keywordOff), i);
+}
+
+/**
+ * @brief LexImage::isKeyword
+ * @param s
+ * @param len
+ * @return 是否为关键字
+ * 关键字表写入时已按字节序排序，直接在映射内存上二分查找
+ */
+bool LexImage::isKeyword(const char *s, qsizetype len) const
+{
+    const QByteArray key=QByteArray::fromRawData(s, len);
+    int lo=0, hi=m_header->keywordNum;
+    while(lo<hi)
+    {
+        int mid=(lo+hi)/2;
+        const QByteArray k=keyword(mid);
+        if(k==key)
+            return true;
+        if(k<key)
+            lo=mid+1;
+        else
+            hi=mid;
+    }
+    return false;
+}
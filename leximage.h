@@ -0,0 +1,100 @@
+/****************************************************
+ * @Copyright © 2021-2023 Lyuyk. All rights reserved.
+ *
+ * @FileName: leximage.h
+ * @Brief: 编译好的最小化DFA的二进制文件头文件
+ * @Module Function: 将导出的最小化DFA（转换表、终态规则号、字符类、规则名、关键字表）
+ *                   写成带版本号的二进制文件；加载时直接内存映射，不做解析，
+ *                   LexScanner可在映射的表上直接扫描
+ *
+ * @Current Version: 1.0
+ * @Author: Lyuyk
+ * @Modifier: Lyuyk
+ * @Finished Date: 2026/10/16
+ *
+ * @Version History: 1.0 current version
+ *
+ ****************************************************/
+#ifndef LEXIMAGE_H
+#define LEXIMAGE_H
+
+#include<QByteArray>
+#include<QFile>
+#include<QString>
+
+#include "lexscanner.h"
+
+/*
+ * 文件布局（本机字节序，各段按4字节对齐，偏移均相对文件开头）：
+ *   Header
+ *   byteClass[256]            qint32，字节→字符类号
+ *   trans[stateNum*classNum]  qint32，“~”边已展开，-1为无此边
+ *   accept[stateNum]          qint32，状态→规则号，-1为非终态
+ *   ruleSkip[ruleNum]         qint32，非0为分词时跳过
+ *   ruleNameOff[ruleNum+1]    quint32，规则名在字符串区中的起止
+ *   keywordOff[keywordNum+1]  quint32，关键字（按字节序排序）在字符串区中的起止
+ *   strings[stringSize]       UTF-8，不含结尾0
+ */
+class LexImage
+{
+public:
+    static const quint32 Magic=0x414C3252;//"R2LA"
+    static const quint32 Version=1;
+
+    struct Header
+    {
+        quint32 magic;
+        quint32 version;
+        quint32 headerSize;//sizeof(Header)，供以后扩展
+        quint32 fileSize;
+        qint32 stateNum;
+        qint32 classNum;
+        qint32 startState;
+        qint32 ruleNum;
+        qint32 keywordNum;
+        quint32 byteClassOff;
+        quint32 transOff;
+        quint32 acceptOff;
+        quint32 ruleSkipOff;
+        quint32 ruleNameOff;
+        quint32 keywordOff;
+        quint32 stringOff;
+        quint32 stringSize;
+    };
+
+public:
+    LexImage();
+    ~LexImage();
+
+    static bool save(const LexTable &table, const QString &filePath, QString *errorStr=nullptr);//写入文件
+
+    bool open(const QString &filePath, QString *errorStr=nullptr);//内存映射并校验文件
+    void close();
+    bool isOpen() const;
+
+    int stateNum() const;
+    int classNum() const;
+    int startState() const;
+    int ruleNum() const;
+    const qint32 *byteClass() const;
+    const qint32 *trans() const;
+    const qint32 *accept() const;
+    bool ruleSkip(int rule) const;
+    QString ruleName(int rule) const;
+
+    int keywordNum() const;
+    QByteArray keyword(int i) const;//返回指向映射内存的QByteArray，不拷贝
+    bool isKeyword(const char *s, qsizetype len) const;//在有序关键字表中二分查找
+
+private:
+    QByteArray string(const quint32 *offsets, int i) const;
+
+private:
+    Q_DISABLE_COPY(LexImage)
+
+    QFile m_file;
+    const uchar *m_data=nullptr;
+    const Header *m_header=nullptr;
+};
+
+#endif // LEXIMAGE_H
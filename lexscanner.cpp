@@ -0,0 +1,221 @@
+/****************************************************
+ * @Copyright © 2021-2023 Lyuyk. All rights reserved.
+ *
+ * @FileName: lexscanner.cpp
+ * @Brief: 最小化DFA的进程内扫描器源文件
+ * @Module Function: 以稠密转换表逐字节执行最小化DFA，最长匹配
+ *
+ * @Current Version: 1.0
+ * @Author: Lyuyk
+ * @Modifier: Lyuyk
+ * @Finished Date: 2026/10/16
+ *
+ * @Version History: 1.0 current version
+ *
+ ****************************************************/
+#include "lexscanner.h"
+#include "leximage.h"
+
+#include<algorithm>
+
+LexScanner::LexScanner(const LexTable &table)
+    : m_table(table)
+{
+    m_classNum=m_table.classNum;
+    m_startState=m_table.startState;
+    m_byteClass=m_table.byteClass.constData();
+    m_trans=m_table.trans.constData();
+    m_accept=m_table.accept.constData();
+    m_ruleNames=m_table.ruleNames;
+    m_ruleSkip=m_table.ruleSkip;
+    for(const auto &keyword: m_table.keywords)
+        m_keywords.append(keyword.toUtf8());
+    std::sort(m_keywords.begin(),m_keywords.end());
+    if(!m_keywords.isEmpty())
+        setKeywordRule();
+}
+
+/**
+ * @brief LexScanner::LexScanner
+ * @param image
+ * 转换表与关键字表不拷贝，只复制规则名与跳过标记
+ */
+LexScanner::LexScanner(const LexImage &image)
+{
+    if(!image.isOpen())
+        return;
+    m_classNum=image.classNum();
+    m_startState=image.startState();
+    m_byteClass=image.byteClass();
+    m_trans=image.trans();
+    m_accept=image.accept();
+    for(int i=0;i<image.ruleNum();i++)
+    {
+        m_ruleNames.append(image.ruleName(i));
+        m_ruleSkip.append(image.ruleSkip(i));
+    }
+    m_image=&image;
+    if(image.keywordNum()>0)
+        setKeywordRule();
+}
+
+/**
+ * @brief LexScanner::setKeywordRule
+ * 与生成的词法分析程序一致，最长匹配恰为关键字表中的词时归为Keyword：
+ * 多规则模式下关键字已是Keyword规则，沿用其规则号；单条正则表达式模式下追加一条Keyword规则
+ */
+void LexScanner::setKeywordRule()
+{
+    m_keywordRule=m_ruleNames.indexOf("Keyword");
+    if(m_keywordRule<0)
+    {
+        m_keywordRule=m_ruleNames.size();
+        m_ruleNames.append("Keyword");
+        m_ruleSkip.append(false);
+    }
+}
+
+bool LexScanner::isKeyword(const char *data, qsizetype len) const
+{
+    if(m_image)
+        return m_image->isKeyword(data, len);
+    return std::binary_search(m_keywords.begin(),m_keywords.end(),QByteArray::fromRawData(data, len));
+}
+
+int LexScanner::ruleNum() const
+{
+    return m_ruleNames.size();
+}
+
+QString LexScanner::ruleName(int rule) const
+{
+    return rule>=0 ? m_ruleNames.value(rule) : QString("Error");
+}
+
+void LexScanner::setSkipWhitespace(bool skip)
+{
+    this->m_skipWhitespace=skip;
+}
+
+/**
+ * @brief LexScanner::match
+ * @param data
+ * @param len
+ * @param rule 输出接受的规则号
+ * @return 整个输入是否被某条规则接受
+ */
+bool LexScanner::match(const char *data, qsizetype len, int *rule) const
+{
+    if(m_startState<0)
+        return false;
+    const qint32 *trans=m_trans;
+    const qint32 *byteClass=m_byteClass;
+    const int classNum=m_classNum;
+
+    int state=m_startState;
+    for(qsizetype i=0;i<len;i++)
+    {
+        state=trans[state*classNum+byteClass[uchar(data[i])]];
+        if(state<0)
+            return false;
+    }
+    int accept=m_accept[state];
+    if(accept>=0 && m_keywordRule>=0 && isKeyword(data, len))
+        accept=m_keywordRule;
+    if(rule)
+        *rule=accept;
+    return accept>=0;
+}
+
+bool LexScanner::match(const QByteArray &data, int *rule) const
+{
+    return match(data.constData(), data.size(), rule);
+}
+
+/**
+ * @brief LexScanner::scanPrefix
+ * @param data
+ * @param len
+ * @param rule 输出最长匹配所接受的规则号
+ * @return 最长匹配前缀的长度，没有任何前缀被接受时返回-1
+ * 逐字节转换并记录最近经过的终态，无法继续转换或输入结束时返回该位置；
+ * 匹配的前缀为关键字时规则号改为关键字规则
+ */
+qsizetype LexScanner::scanPrefix(const char *data, qsizetype len, int *rule) const
+{
+    if(m_startState<0)
+        return -1;
+    const qint32 *trans=m_trans;
+    const qint32 *byteClass=m_byteClass;
+    const qint32 *accept=m_accept;
+    const int classNum=m_classNum;
+
+    int state=m_startState;
+    qsizetype lastLen=-1;
+    int lastRule=-1;
+    for(qsizetype i=0;i<len;i++)
+    {
+        state=trans[state*classNum+byteClass[uchar(data[i])]];
+        if(state<0)
+            break;
+        if(accept[state]>=0)
+        {
+            lastLen=i+1;
+            lastRule=accept[state];
+        }
+    }
+    if(lastLen>0 && m_keywordRule>=0 && isKeyword(data, lastLen))
+        lastRule=m_keywordRule;
+    if(rule)
+        *rule=lastRule;
+    return lastLen;
+}
+
+qsizetype LexScanner::scanPrefix(const QByteArray &data, int *rule) const
+{
+    return scanPrefix(data.constData(), data.size(), rule);
+}
+
+/**
+ * @brief LexScanner::tokenize
+ * @param data
+ * @param len
+ * @param callback
+ * @return 已处理的字节数，回调要求停止时小于len
+ * 反复取最长匹配前缀作为单词；无法识别的字节以规则号-1的单字节单词报告后跳过，
+ * 标记为跳过的规则（如注释）不回调
+ */
+qsizetype LexScanner::tokenize(const char *data, qsizetype len, const TokenCallback &callback) const
+{
+    qsizetype pos=0;
+    while(pos<len)
+    {
+        char ch=data[pos];
+        if(m_skipWhitespace && (ch==' ' || ch=='\n' || ch=='\t'))
+        {
+            pos++;
+            continue;
+        }
+
+        Token token;
+        token.offset=pos;
+        token.length=scanPrefix(data+pos, len-pos, &token.rule);
+        if(token.length<=0)
+        {
+            token.rule=-1;
+            token.length=1;
+        }
+        pos+=token.length;
+
+        if(token.rule>=0 && m_ruleSkip.value(token.rule))
+            continue;
+        if(!callback(token))
+            return pos;
+    }
+    return pos;
+}
+
+qsizetype LexScanner::tokenize(const QByteArray &data, const TokenCallback &callback) const
+{
+    return tokenize(data.constData(), data.size(), callback);
+}
@@ -0,0 +1,93 @@
+/****************************************************
+ * @Copyright © 2021-2023 Lyuyk. All rights reserved.
+ *
+ * @FileName: lexscanner.h
+ * @Brief: 最小化DFA的进程内扫描器头文件
+ * @Module Function: 直接在内存中的字节串上执行编译好的最小化DFA，
+ *                   提供整体匹配、最长前缀匹配与分词接口，无需生成、编译词法分析程序
+ *
+ * @Current Version: 1.0
+ * @Author: Lyuyk
+ * @Modifier: Lyuyk
+ * @Finished Date: 2026/10/16
+ *
+ * @Version History: 1.0 current version
+ *
+ ****************************************************/
+#ifndef LEXSCANNER_H
+#define LEXSCANNER_H
+
+#include<QByteArray>
+#include<QList>
+#include<QStringList>
+
+#include<functional>
+
+class LexImage;
+
+//由NDFA::exportTable导出的最小化DFA，与NDFA对象无关，可单独保存、复制
+struct LexTable
+{
+    int stateNum=0;//状态数
+    int classNum=0;//字符类数
+    int startState=-1;//初态
+    QList<int> byteClass;//字节(0~255)→字符类号
+    QList<int> trans;//转换表 trans[s*classNum+c]，“~”边已展开，-1为无此边
+    QList<int> accept;//状态→接受的规则号，-1为非终态
+    QStringList ruleNames;//规则号→单词类别名
+    QList<bool> ruleSkip;//规则号→分词时是否跳过
+    QStringList keywords;//关键字表（单条正则表达式模式下由词法分析程序与LexScanner按表识别）
+
+    bool isValid() const { return startState>=0; }
+};
+
+class LexScanner
+{
+public:
+    //单词：规则号为-1表示无法识别的单个字节
+    struct Token
+    {
+        int rule;//规则号
+        qsizetype offset;//在输入中的起始位置
+        qsizetype length;//长度
+    };
+
+    //分词回调，返回false时停止分词
+    typedef std::function<bool(const Token &)> TokenCallback;
+
+public:
+    explicit LexScanner(const LexTable &table);
+    explicit LexScanner(const LexImage &image);//直接在映射的自动机文件上扫描，image须在扫描器之前打开、之后关闭
+
+    int ruleNum() const;//有关键字表而规则中没有Keyword时，末尾追加一条Keyword规则
+    QString ruleName(int rule) const;//规则号→单词类别名，-1为Error
+    void setSkipWhitespace(bool skip);//分词时是否跳过空格、换行、制表符（与生成的词法分析程序一致，默认跳过）
+
+    bool match(const char *data, qsizetype len, int *rule=nullptr) const;//整个输入是否恰好为一个单词
+    bool match(const QByteArray &data, int *rule=nullptr) const;
+    qsizetype scanPrefix(const char *data, qsizetype len, int *rule=nullptr) const;//最长匹配前缀的长度，无匹配时为-1
+    qsizetype scanPrefix(const QByteArray &data, int *rule=nullptr) const;
+    qsizetype tokenize(const char *data, qsizetype len, const TokenCallback &callback) const;//分词，返回已处理的字节数
+    qsizetype tokenize(const QByteArray &data, const TokenCallback &callback) const;
+
+private:
+    void setKeywordRule();
+    bool isKeyword(const char *data, qsizetype len) const;
+
+private:
+    //扫描所用的表：由LexTable构造时指向其副本m_table，由LexImage构造时指向映射内存
+    LexTable m_table;
+    int m_classNum=0;
+    int m_startState=-1;
+    const qint32 *m_byteClass=nullptr;
+    const qint32 *m_trans=nullptr;
+    const qint32 *m_accept=nullptr;
+    QStringList m_ruleNames;
+    QList<bool> m_ruleSkip;
+    const LexImage *m_image=nullptr;//由LexImage构造时在映射的关键字表中查找
+    QList<QByteArray> m_keywords;//由LexTable构造时的关键字表（按字节序排序）
+    int m_keywordRule=-1;//关键字归入的规则号，无关键字时为-1
+    bool m_skipWhitespace=true;
+};
+
+#endif // LEXSCANNER_H
@@ -22,8 +22,10 @@
 #include <QHash>
 #include <QDebug>
 #include <QFileDialog>
+#include <QHeaderView>
 #include <QMessageBox>
 #include <QTextStream>
+#include <QTime>
 //std lib
 #include <vector>
 #include <queue>
@@ -45,9 +47,20 @@ MainWindow::MainWindow(QWidget *parent)
     connect(ui->action_Lexer,&QAction::triggered,this,&MainWindow::on_pushButton_Lexer_clicked);//最小化DFA生成Lexer
 
     /*表格属性设置*/
-    ui->tableWidget_NFA->setEditTriggers(QAbstractItemView::NoEditTriggers);//不允许编辑
-    ui->tableWidget_DFA->setEditTriggers(QAbstractItemView::NoEditTriggers);
-    ui->tableWidget_mDFA->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_NFAModel=new FATableModel(NDFA::NFAPhase, this);
+    m_DFAModel=new FATableModel(NDFA::DFAPhase, this);
+    m_mDFAModel=new FATableModel(NDFA::mDFAPhase, this);
+    ui->tableView_NFA->setModel(m_NFAModel);
+    ui->tableView_DFA->setModel(m_DFAModel);
+    ui->tableView_mDFA->setModel(m_mDFAModel);
+    for(QTableView *view: {ui->tableView_NFA, ui->tableView_DFA, ui->tableView_mDFA})
+    {
+        view->setEditTriggers(QAbstractItemView::NoEditTriggers);//不允许编辑
+        view->verticalHeader()->setHidden(true);//竖轴隐藏
+        view->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);//行高固定，不逐行计算
+        view->setAlternatingRowColors(true);//隔行变色
+        view->setPalette(QPalette(qRgb(240,240,240)));
+    }
 
     /*界面初始化*/
     ui->tabWidget_Graph->setCurrentIndex(0);
@@ -56,6 +69,12 @@ MainWindow::MainWindow(QWidget *parent)
     ui->pushButton_2DFA->setDisabled(true);//功能未能使用前禁用按钮
     ui->pushButton_mDFA->setDisabled(true);
     ui->pushButton_Lexer->setDisabled(true);
+    ui->pushButton_cancel->setDisabled(true);
+
+    /*转换工作线程*/
+    m_worker=new NDFAWorker(&NDFAG, this);
+    connect(m_worker,&NDFAWorker::progress,this,&MainWindow::onConvertProgress);
+    connect(m_worker,&QThread::finished,this,&MainWindow::onConvertFinished);
 
     /*一些参数的初始化*/
     regexStr="";
@@ -64,6 +83,9 @@ MainWindow::MainWindow(QWidget *parent)
 
 MainWindow::~MainWindow()
 {
+    //NDFAG先于子对象析构，须先结束工作线程
+    m_worker->cancel();
+    m_worker->wait();
     delete ui;
 }
 
@@ -88,16 +110,20 @@ void MainWindow::on_pushButton_openRegexFile_clicked()
     QTextStream textInput(&srcFile);
     textInput.setEncoding(QStringConverter::Utf8);//设置编码，防止中文乱码
 
-    QString line;
+    QStringList lines;
     printConsole("读取正则表达式文件...");
 
-    line=textInput.readLine().toUtf8().trimmed();//按行读取文件
-    regexStr.append(line);
-    ui->plainTextEdit_Regex->appendPlainText(line);//一行行显示
+    while(!textInput.atEnd())
+        lines.append(textInput.readLine().trimmed());//按行读取文件
+    for(const auto &line: lines)
+        ui->plainTextEdit_Regex->appendPlainText(line);//一行行显示
 
-    line=textInput.readLine().toUtf8().trimmed();//第二行 关键字（规定）
-    keywordStr=line;//初始化regexStr
-    ui->plainTextEdit_Regex->appendPlainText(line);//一行行显示
+    //多规则格式的关键字由%keyword给出，转换时从文本中解析
+    if(!NDFA::isRuleFile(lines))
+    {
+        regexStr.append(lines.value(0));
+        keywordStr=lines.value(1);//第二行 关键字（规定）
+    }
 
     srcFile.close();
 
@@ -127,60 +153,204 @@ void MainWindow::on_pushButton_saveRegexToFile_clicked()
 }
 
 
+/**
+ * @brief MainWindow::on_pushButton_2NFA_clicked
+ * 正则表达式（或多规则）转换为NFA的槽函数，在工作线程中转换，结果在onConvertFinished中显示
+ */
 void MainWindow::on_pushButton_2NFA_clicked()
 {
-    regexStr=ui->plainTextEdit_Regex->toPlainText().split('\n').at(0);//获取正则表达式
-
-    NDFAG.setKeywordStr(keywordStr);
-    NDFAG.reg2NFA(regexStr);//调用转换函数
-    printConsole("正则表达式已转换为NFA");
-
-    NDFAG.printNFA(ui->tableWidget_NFA);//显示
+    if(m_worker->isRunning())
+        return;
+    QStringList lines=ui->plainTextEdit_Regex->toPlainText().split('\n');
+    if(NDFA::isRuleFile(lines))
+    {
+        //多规则格式；先解析，解析失败时保留上次的自动机与按钮状态
+        QList<NDFA::LexRule> rules;
+        QString keywords, errorStr;
+        if(!NDFA::parseRules(lines, rules, keywords, errorStr))
+        {
+            QMessageBox::warning(NULL, "规则", errorStr);
+            return;
+        }
+        keywordStr=keywords;
+        showTables(false);//表格模型不再读取旧的自动机
+        NDFAG.init();//重新转换前复位
+        NDFAG.setKeywordStr(keywordStr);
+        setConverting(true);
+        m_worker->startRules(rules);//调用转换函数
+    }
+    else
+    {
+        regexStr=lines.at(0);//获取正则表达式
 
-    ui->tabWidget_Graph->setCurrentIndex(1);//设置显示页面
-    ui->pushButton_2DFA->setEnabled(true);//完成转换工作后可以允许NFA到DFA的转换工作
+        showTables(false);
+        NDFAG.init();
+        NDFAG.setKeywordStr(keywordStr);
+        setConverting(true);
+        m_worker->startRegex(regexStr);//调用转换函数
+    }
 }
 
 /**
  * @brief MainWindow::on_pushButton_2DFA_clicked
- * NFA转换为DFA的槽函数，调用NFA转DFA主函数及相关交互函数操作
+ * NFA转换为DFA的槽函数，在工作线程中执行子集构造
  */
 void MainWindow::on_pushButton_2DFA_clicked()
 {
+    if(m_worker->isRunning())
+        return;
     printConsole("转换NFA...");
-    NDFAG.NFA2DFA();
-    printConsole("NFA已转换为DFA");
-    /*======================显示处理========================*/
-
-    ui->tabWidget_Graph->setCurrentIndex(2);
-    NDFAG.printDFA(ui->tableWidget_DFA);
-
-    /*======================交互界面处理========================*/
-
-    ui->pushButton_mDFA->setEnabled(true);//允许最小化DFA
+    setConverting(true);
+    m_worker->startTask(NDFAWorker::DFATask);
 }
 
 
 /**
  * @brief MainWindow::on_pushButton_mDFA_clicked
- * 最小化DFA并将其状态转换表显示出来
+ * 最小化DFA的槽函数，在工作线程中求等价划分
  */
 void MainWindow::on_pushButton_mDFA_clicked()
 {
+    if(m_worker->isRunning())
+        return;
     printConsole("最小化DFA...");
-    NDFAG.DFA2mDFA();//调用转换函数
-    printConsole("DFA最小化完成...");
+    setConverting(true);
+    m_worker->startTask(NDFAWorker::mDFATask);
+}
 
-    /*==========显示处理=================*/
+/**
+ * @brief MainWindow::on_pushButton_cancel_clicked
+ * 请求中止正在进行的转换，工作线程在下一个检查点结束
+ */
+void MainWindow::on_pushButton_cancel_clicked()
+{
+    if(!m_worker->isRunning())
+        return;
+    printConsole("正在取消...");
+    ui->pushButton_cancel->setDisabled(true);
+    m_worker->cancel();
+}
 
-    NDFAG.printMDFA(ui->tableWidget_mDFA);
+/**
+ * @brief MainWindow::onConvertProgress
+ * @param phase
+ * @param count
+ * 显示工作线程报告的转换进度
+ */
+void MainWindow::onConvertProgress(int phase, int count)
+{
+    if(phase==NDFA::DFAPhase)
+        printConsole("子集构造中，已发现"+QString::number(count)+"个DFA状态...");
+    else if(phase==NDFA::mDFAPhase)
+        printConsole("最小化中，当前"+QString::number(count)+"个划分...");
+}
 
-    //切换表格
-    ui->tabWidget_Graph->setCurrentIndex(3);
+/**
+ * @brief MainWindow::onConvertFinished
+ * 工作线程结束后在主线程中显示转换结果并更新按钮；被中止时丢弃该阶段的结果
+ */
+void MainWindow::onConvertFinished()
+{
+    setConverting(false);
+    showTables(true);//显示
+    const bool completed=m_worker->isCompleted();
+    switch(m_worker->task())
+    {
+    case NDFAWorker::NFATask:
+        if(!completed)
+        {
+            printConsole("正则表达式有误："+NDFAG.errorString());
+            break;
+        }
+        if(m_worker->isRuleMode())
+            printConsole("词法规则已转换为NFA，共"+QString::number(NDFAG.phaseStats().ruleNum)+"条规则");
+        else
+            printConsole("正则表达式已转换为NFA");
+        printConsole(NDFAG.phaseStats().summary(NDFA::NFAPhase));
+
+        ui->tabWidget_Graph->setCurrentIndex(1);//设置显示页面
+        ui->pushButton_2DFA->setEnabled(true);//完成转换工作后可以允许NFA到DFA的转换工作
+        break;
+
+    case NDFAWorker::DFATask:
+        if(!completed)
+        {
+            printConsole("NFA转换DFA已取消");
+            ui->pushButton_2DFA->setEnabled(true);//可重新转换
+            break;
+        }
+        printConsole("NFA已转换为DFA");
+        printConsole(NDFAG.phaseStats().summary(NDFA::DFAPhase));
+        /*======================显示处理========================*/
+
+        ui->tabWidget_Graph->setCurrentIndex(2);
+
+        /*======================交互界面处理========================*/
+
+        ui->pushButton_2DFA->setEnabled(true);
+        ui->pushButton_mDFA->setEnabled(true);//允许最小化DFA
+        break;
+
+    case NDFAWorker::mDFATask:
+        ui->pushButton_2DFA->setEnabled(true);
+        ui->pushButton_mDFA->setEnabled(true);
+        if(!completed)
+        {
+            printConsole("DFA最小化已取消");
+            break;
+        }
+        printConsole("DFA最小化完成...");
+        printConsole(NDFAG.phaseStats().summary(NDFA::mDFAPhase));
+        printConsole(NDFAG.phaseStats().arenaSummary());
+
+        /*==========显示处理=================*/
+
+        //切换表格
+        ui->tabWidget_Graph->setCurrentIndex(3);
+
+        /*======================交互界面处理========================*/
+
+        ui->pushButton_Lexer->setEnabled(true);
+        break;
+    }
+}
 
-    /*======================交互界面处理========================*/
+/**
+ * @brief MainWindow::showTables
+ * @param visible
+ * 为真时三个表格模型重新读取NDFAG（未构造的阶段为空表），为假时清空表格、不再访问NDFAG；
+ * 列宽按可见部分的内容调整
+ */
+void MainWindow::showTables(bool visible)
+{
+    m_NFAModel->setAutomaton(visible ? &NDFAG : nullptr);
+    m_DFAModel->setAutomaton(visible ? &NDFAG : nullptr);
+    m_mDFAModel->setAutomaton(visible ? &NDFAG : nullptr);
+    if(visible)
+    {
+        ui->tableView_NFA->resizeColumnsToContents();
+        ui->tableView_DFA->resizeColumnsToContents();
+        ui->tableView_mDFA->resizeColumnsToContents();
+    }
+}
 
-    ui->pushButton_Lexer->setEnabled(true);
+/**
+ * @brief MainWindow::setConverting
+ * @param converting
+ * 转换开始时禁用所有转换按钮（结束后由onConvertFinished按结果重新启用后续阶段），启用取消按钮
+ */
+void MainWindow::setConverting(bool converting)
+{
+    ui->pushButton_2NFA->setDisabled(converting);
+    ui->pushButton_clearConsole->setDisabled(converting);
+    ui->pushButton_cancel->setEnabled(converting);
+    if(converting)
+    {
+        showTables(false);//工作线程修改NDFAG期间表格不得读取
+        ui->pushButton_2DFA->setDisabled(true);
+        ui->pushButton_mDFA->setDisabled(true);
+        ui->pushButton_Lexer->setDisabled(true);
+    }
 }
 
 /**
@@ -189,6 +359,8 @@ void MainWindow::on_pushButton_mDFA_clicked()
  */
 void MainWindow::on_pushButton_Lexer_clicked()
 {
+    if(m_worker->isRunning())
+        return;
     QString t_filePath=QFileDialog::getExistingDirectory(this,"选择词法分析程序生成路径",QDir::currentPath());
     if(t_filePath.isEmpty())
         return;
@@ -198,6 +370,7 @@ void MainWindow::on_pushButton_Lexer_clicked()
     printConsole("生成词法分析程序...");
     NDFAG.mDFA2Lexer(srcFilePath);//调用主函数
     printConsole("词法分析程序生成完成");
+    printConsole(NDFAG.phaseStats().summary(NDFA::LexerPhase));
 
     /*==========显示处理=================*/
     //切换表格
@@ -237,20 +410,13 @@ void MainWindow::printConsole(QString str)
  */
 void MainWindow::on_pushButton_clearConsole_clicked()
 {        
+    if(m_worker->isRunning())
+        return;
     /*界面初始化*/
     ui->tabWidget_Graph->setCurrentIndex(0);
     //ui->plainTextEdit_console->clear();
     ui->plainTextEdit_Regex->clear();
     ui->plainTextEdit_Lexer->clear();
-    ui->tableWidget_NFA->clear();    
-    ui->tableWidget_DFA->clear();
-    ui->tableWidget_mDFA->clear();
-    ui->tableWidget_NFA->setRowCount(0);
-    ui->tableWidget_NFA->setColumnCount(0);
-    ui->tableWidget_DFA->setRowCount(0);
-    ui->tableWidget_DFA->setColumnCount(0);
-    ui->tableWidget_mDFA->setRowCount(0);
-    ui->tableWidget_mDFA->setColumnCount(0);
 
     /*按键操作初始化*/
     ui->pushButton_2NFA->setEnabled(true);
@@ -261,6 +427,7 @@ void MainWindow::on_pushButton_clearConsole_clicked()
     /*一些参数的初始化*/
     regexStr="";
     NDFAG.init();
+    showTables(true);
 }
 
 
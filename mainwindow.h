@@ -20,7 +20,9 @@
 #include <QMainWindow>
 #include <set>
 
+#include "fatablemodel.h"
 #include "ndfa.h"
+#include "ndfaworker.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -51,8 +53,16 @@ private slots:
 
     void on_pushButton_Lexer_clicked();
 
+    void on_pushButton_cancel_clicked();
+
+    void onConvertProgress(int phase, int count);
+
+    void onConvertFinished();
+
 private:
     void printConsole(QString str);
+    void showTables(bool visible);//表格显示NDFAG中的自动机或清空
+    void setConverting(bool converting);//转换进行中禁用各转换按钮，启用取消按钮
 
 private:    
     Ui::MainWindow *ui;
@@ -63,6 +73,10 @@ private:
     QString tmpFilePath;//
 
     NDFA NDFAG;//FA自动机类
+    FATableModel *m_NFAModel;//三个状态转换表的模型，按需读取NDFAG
+    FATableModel *m_DFAModel;
+    FATableModel *m_mDFAModel;
+    NDFAWorker *m_worker;//在其中执行转换的工作线程，运行期间不访问NDFAG
 
 };
 #endif // MAINWINDOW_H
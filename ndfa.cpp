@@ -17,6 +17,11 @@
  ****************************************************/
 #include "ndfa.h"
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QJsonObject>
+
+#include <algorithm>
+#include <climits>
 
 NDFA::NDFA()
 {
@@ -30,247 +35,176 @@ NDFA::NDFA()
 void NDFA::init()
 {
     //初始化FA状态计数
-    m_NFAStateNum=0;
+    clearNFA();
     m_DFAStateNum=0;
     m_mDFAStateNum=0;
-    m_opCharSet.clear();
     m_DFAEndStateSet.clear();
+    m_DFAAccept.clear();
+    m_mDFAAccept.clear();
     m_keyWordSet.clear();
     m_reg_keyword_str.clear();
     m_lexerCodeStr.clear();
-    m_dividedSet->clear();
+    m_dividedSet.clear();
 
     //FA图初始化
-    m_NFAG.startNode=NULL;
-    m_NFAG.endNode=NULL;
     m_mDFAG.startState=-1;
     m_mDFAG.endStateSet.clear();
 
-    //NFA节点数组初始化
-    for(int i=0;i<ARR_MAX_SIZE;i++)
-    {
-        m_NFAStateArr[i].init();
-        m_NFAStateArr[i].stateNum=i;
-    }
+    //状态数组清空，节点在构造过程中按需追加
+    m_DFAStateArr.clear();
+    m_mDFANodeArr.clear();
+    m_DFATrans.clear();
+    m_mDFATrans.clear();
+    m_phaseStats.init();
 
-    //DFA节点数组初始化
-    for(int i=0;i<ARR_MAX_SIZE;i++)
+    //上一次编译从内存池分配的对象都已随上面的清空析构，整体归还
+    m_arena.release();
+}
+
+/**
+ * @brief NDFA::tableRowCount
+ * @param phase NFAPhase、DFAPhase或mDFAPhase
+ * @return 该阶段状态转换表的行数，即状态数
+ */
+int NDFA::tableRowCount(Phase phase) const
+{
+    switch(phase)
     {
-        m_DFAStateArr[i].init();
-        m_DFAStateArr[i].stateNum=i;
+    case NFAPhase:
+        return m_NFAStateNum;
+    case DFAPhase:
+        return m_DFAStateNum;
+    case mDFAPhase:
+        return m_mDFAStateNum;
+    default:
+        return 0;
     }
+}
 
-    //mDFA节点数组初始化优化
-    for(int i=0;i<ARR_MAX_SIZE;i++)
+/**
+ * @brief NDFA::tableColumnCount
+ * @param phase
+ * @return 列数：NFA为 状态号、各操作符、epsilon、初/终态；
+ * DFA为 状态号、包含的NFA状态、各字符类、初/终态；mDFA为 状态号、各字符类、初/终态
+ */
+int NDFA::tableColumnCount(Phase phase) const
+{
+    switch(phase)
     {
-        m_mDFANodeArr[i].init();
+    case NFAPhase:
+        return m_opCharList.size()+3;
+    case DFAPhase:
+        return m_classNum+3;
+    case mDFAPhase:
+        return m_classNum+2;
+    default:
+        return 0;
     }
 }
 
-void NDFA::printNFA(QTableWidget *table)
+/**
+ * @brief NDFA::tableHeader
+ * @param phase
+ * @param column
+ * @return 第column列的表头
+ */
+QString NDFA::tableHeader(Phase phase, int column) const
 {
-    int epsColN=m_opCharSet.size()+1;//最后一列 epsilon 列号
-
-    //初始化表头
-    QStringList headerStrList=m_opCharSet.values();
-    headerStrList.push_front("状态号");
-    headerStrList.push_back("epsilon");
-    headerStrList.push_back("初/终态");
-
-    table->setRowCount(m_NFAStateNum);
-    table->setColumnCount(m_opCharSet.size()+3);
-    //设置表头 行
-    table->setHorizontalHeaderLabels(headerStrList);
-    //竖轴隐藏
-    table->verticalHeader()->setHidden(true);
-    table->setAlternatingRowColors(true);//隔行变色
-    table->setPalette(QPalette(qRgb(240,240,240)));
-    table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);//自动调整列宽
-
-
-    for(int state=0;state<m_NFAStateNum;state++)
+    const int lastCol=tableColumnCount(phase)-1;
+    if(column==0)
+        return "状态号";
+    if(column==lastCol)
+        return "初/终态";
+    switch(phase)
     {
-        table->setItem(state,0,
-                       new QTableWidgetItem(QString::number(state)));
-        table->item(state,0)->setTextAlignment(Qt::AlignCenter);//居中
-
-        int k=1;
-        int colN=1;
-
-        for(;k<headerStrList.size()-2;k++)
-        {
-            if(m_NFAStateArr[state].value==headerStrList[k])
-            {
-                table->setItem(state,colN,
-                               new QTableWidgetItem(
-                                   QString::number(m_NFAStateArr[state].toState)));
-                table->item(state,colN)->setTextAlignment(Qt::AlignCenter);//居中
-            }
-            colN++;
-        }
-
-        QString epsStr="";
-        //qDebug()<<NFAStateArr[state].epsToSet;
-        for(const auto &e_state: m_NFAStateArr[state].epsToSet)
-        {
-            epsStr+=QString::number(e_state)+",";
-        }
-        epsStr.chop(1);
-        table->setItem(state,epsColN,new QTableWidgetItem(epsStr));
-        table->item(state,epsColN)->setTextAlignment(Qt::AlignCenter);//居中
-
-        if(m_NFAStateArr[state].stateNum==m_NFAG.startNode->stateNum)
-        {//若为初态
-            table->setItem(state,epsColN+1,new QTableWidgetItem("初态"));
-            table->item(state,epsColN+1)->setTextAlignment(Qt::AlignCenter);//居中
-        }
-        if(m_NFAStateArr[state].stateNum==m_NFAG.endNode->stateNum)
-        {//若为终态
-            table->setItem(state,epsColN+1,new QTableWidgetItem("终态"));
-            table->item(state,epsColN+1)->setTextAlignment(Qt::AlignCenter);//居中
-        }
+    case NFAPhase:
+        return column==lastCol-1 ? "epsilon" : m_opCharList.value(column-1);
+    case DFAPhase:
+        if(column==1)
+            return m_constructEngine==FollowposConstruct ? "包含的位置" : "包含的NFA状态";
+        return classLabel(column-2);
+    case mDFAPhase:
+        return classLabel(column-1);
+    default:
+        return QString();
     }
 }
 
-void NDFA::printDFA(QTableWidget *table)
+/**
+ * @brief NDFA::tableCell
+ * @param phase
+ * @param row 状态号
+ * @param column
+ * @return 状态转换表第row行第column列的内容，无边时为空串
+ * 只在显示时按需生成，不为整张表预先生成字符串
+ */
+QString NDFA::tableCell(Phase phase, int row, int column) const
 {
-    //初始化
-    table->clear();table->setRowCount(0);table->setColumnCount(0);
-
-    table->setRowCount(m_DFAStateNum);//表格行数
-    table->setColumnCount(m_opCharSet.count()+3);//表格列数（状态号，包含NFA状态，操作符。。。，初/终态）
-    table->verticalHeader()->setHidden(true);//隐藏竖轴序号列
-    table->setAlternatingRowColors(true);//隔行变色
-    table->setPalette(QPalette(qRgb(240,240,240)));
-
+    const int lastCol=tableColumnCount(phase)-1;
+    if(column==0)
+        return QString::number(row);
 
-    //表头初始化
-    QStringList headerStrList=m_opCharSet.values();
-    headerStrList.push_front("包含的NFA状态");
-    headerStrList.push_front("状态号");
-    headerStrList.push_back("初/终态");
-    //水平表头
-    table->setHorizontalHeaderLabels(headerStrList);
-
-    //遍历所有DFA节点
-    for(int state=0;state<m_DFAStateNum;state++)
+    switch(phase)
     {
-        //设置状态号
-        table->setItem(state,0,
-                       new QTableWidgetItem(QString::number(m_DFAStateArr[state].stateNum)));
-        table->item(state,0)->setTextAlignment(Qt::AlignCenter);//居中
-        //NFA状态集
-        QString NFASetStr="{ ";
-        for(const auto &n_state:m_DFAStateArr[state].NFANodeSet)
-        {
-            NFASetStr+=QString::number(n_state)+",";
-        }
-        NFASetStr.replace(NFASetStr.size()-1,1," }");
-        table->setItem(state,1,new QTableWidgetItem(NFASetStr));
-
-        int k=2;//从第一个操作符开始
-        int colN=2;//第三列开始显示
-        for(;k<headerStrList.count()-1;k++)
+    case NFAPhase:
+    {
+        const NFANode &node=m_NFAStateArr.at(row);
+        if(column==lastCol)
         {
-            QString curOpChar=headerStrList[k];//当前操作符
-
-            if(m_DFAStateArr[state].DFAEdgeMap.contains(curOpChar))//若可达
-            {
-                //可以去到的状态号
-                int toState=m_DFAStateArr[state].DFAEdgeMap[curOpChar];
-
-//                QString n_NFASetStr=QString::number(toState)+" { ";
-//                for(const auto &n_state:m_DFAStateArr[toState].NFANodeSet)//可去到的状态集
-//                {
-//                    n_NFASetStr+=QString::number(n_state)+",";
-//                }
-//                n_NFASetStr.replace(n_NFASetStr.size()-1,1," }");
-                //状态多起来显示集合很麻烦
-                table->setItem(state,colN,new QTableWidgetItem(QString::number(toState)));
-                table->item(state,colN)->setTextAlignment(Qt::AlignCenter);//居中
-            }
-            colN++;
-        }
-
-        if(m_DFAEndStateSet.contains(state))
-        {//若为终态
-            table->setItem(state,colN,new QTableWidgetItem("终态"));
-            table->item(state,colN)->setTextAlignment(Qt::AlignCenter);//居中
+            if(node.acceptRule>=0)//若为终态
+                return acceptLabel(node.acceptRule);
+            return row==m_NFAG.startState ? "初态" : QString();
         }
-        else if(m_DFAStateArr[state].NFANodeSet.contains(m_NFAG.startNode->stateNum))
+        if(column==lastCol-1)
         {
-            table->setItem(state,colN,new QTableWidgetItem("初态"));
-            table->item(state,colN)->setTextAlignment(Qt::AlignCenter);//居中
+            QStringList epsList;
+            for(int i=m_NFAEpsOff[row];i<m_NFAEpsOff[row+1];i++)
+                epsList.append(QString::number(m_NFAEpsTo[i]));
+            return epsList.join(',');
         }
+        return node.symbol==column-1 ? QString::number(node.toState) : QString();
     }
-    table->resizeRowsToContents();//自适应行高
-}
-
-void NDFA::printMDFA(QTableWidget *table)
-{
-    //初始化
-    table->clear();table->setRowCount(0);table->setColumnCount(0);
-
-    table->setRowCount(m_mDFAStateNum);//表格行数
-    table->setColumnCount(m_opCharSet.count()+2);//表格列数
-    table->verticalHeader()->setHidden(true);//隐藏竖轴序号列
-    table->setAlternatingRowColors(true);//隔行变色
-    table->setPalette(QPalette(qRgb(240,240,240)));
-    table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);//自动调整列宽
-
-    //表头初始化
-    QStringList headerStrList=m_opCharSet.values();
-    headerStrList.push_front("状态号");
-    headerStrList.push_back("初/终态");
-    //设置水平表头
-    table->setHorizontalHeaderLabels(headerStrList);
-
-    for(int stateId=0;stateId<m_mDFAStateNum;stateId++)
+    case DFAPhase:
     {
-        int k=1;//第一个状态开始
-        int colN=1;
-
-        table->setItem(stateId, 0,
-                       new QTableWidgetItem(QString::number(stateId)));//列 状态号
-        table->item(stateId,0)->setTextAlignment(Qt::AlignCenter);
-
-        //遍历所有操作符
-        for( ;k<headerStrList.count()-1;k++)
+        if(column==lastCol)
         {
-            QString curOpChar=headerStrList[k];//当前操作符
-            if(m_mDFANodeArr[stateId].mDFAEdgesMap.contains(curOpChar))
-            {
-                //若通过当前操作符可达
-                int toIdx=m_mDFANodeArr[stateId].mDFAEdgesMap[curOpChar];
-
-                table->setItem(stateId,colN,new QTableWidgetItem(QString::number(toIdx)));
-                table->item(stateId,colN)->setTextAlignment(Qt::AlignCenter);//居中
-            }
-            colN++;
+            if(m_DFAEndStateSet.contains(row))//若为终态
+                return acceptLabel(m_DFAAccept[row]);
+            return row==0 ? "初态" : QString();//DFA初态恒为0号
         }
-
-        if(m_mDFAG.endStateSet.contains(stateId))
+        if(column==1)//NFA状态集
         {
-            //若为初态
-            table->setItem(stateId,colN,
-                           new QTableWidgetItem("终态"));
-            table->item(stateId,colN)->setTextAlignment(Qt::AlignCenter);//居中
+            QStringList NFASetList;
+            for(const auto &n_state: m_DFAStateArr.at(row).NFANodeSet)
+                NFASetList.append(QString::number(n_state));
+            return "{ "+NFASetList.join(',')+" }";
         }
-        else if(stateId==m_mDFAG.startState)
+        int toState=m_DFATrans.at(row*m_classNum+column-2);
+        return toState>=0 ? QString::number(toState) : QString();
+    }
+    case mDFAPhase:
+    {
+        if(column==lastCol)
         {
-            //若为终态
-            table->setItem(stateId,colN,
-                           new QTableWidgetItem("初态"));
-            table->item(stateId,colN)->setTextAlignment(Qt::AlignCenter);//居中
+            if(m_mDFAG.endStateSet.contains(row))//若为终态
+                return acceptLabel(m_mDFAAccept[row]);
+            return row==m_mDFAG.startState ? "初态" : QString();
         }
+        int toIdx=m_mDFATrans.at(row*m_classNum+column-1);
+        return toIdx>=0 ? QString::number(toIdx) : QString();
+    }
+    default:
+        return QString();
     }
 }
 
+#ifdef QT_WIDGETS_LIB
 void NDFA::printLexer(QPlainTextEdit *widget)
 {
     widget->clear();
     widget->setPlainText(m_lexerCodeStr);
 }
+#endif
 
 /**
  * @brief NDFA::strToNfa
@@ -279,10 +213,82 @@ void NDFA::printLexer(QPlainTextEdit *widget)
  * @return
  */
 NDFA::NFAGraph NDFA::strToNfa(QString s)
+{
+    return postfixToNfa(regexToPostfix(s));
+}
+
+/**
+ * @brief classEnd
+ * @param s
+ * @param pos '['的位置
+ * @return 字符类结尾']'的位置，没有结尾时为-1（'['按普通字符处理）
+ * 字符类中`转义下一个字符
+ */
+static int classEnd(const QString &s, int pos)
+{
+    for(int j=pos+1;j<s.size();j++)
+    {
+        if(s[j]=='`')
+            j++;
+        else if(s[j]==']')
+            return j;
+    }
+    return -1;
+}
+
+/**
+ * @brief parseRepeat
+ * @param s
+ * @param pos '{'的位置
+ * @param minCount
+ * @param maxCount 无上限时为-1
+ * @return 计数重复结尾'}'的位置；不是{m}、{m,}、{m,n}（n≥m且n>0）时为-1，'{'按普通字符处理。
+ * 此处不限制次数，超过上限的由regexToPostfix报错
+ */
+static int parseRepeat(const QString &s, int pos, int &minCount, int &maxCount)
+{
+    const int close=s.indexOf('}', pos);
+    if(pos>=s.size() || s[pos]!='{' || close<0)
+        return -1;
+    auto toCount=[](const QString &str, int &count){
+        if(str.isEmpty())
+            return false;
+        for(const auto &ch: str)
+            if(ch<'0' || ch>'9')
+                return false;
+        count=str.size()>9 ? INT_MAX : str.toInt();//过大的次数由调用方按上限报错
+        return true;
+    };
+    const QStringList bounds=s.mid(pos+1, close-pos-1).split(',');
+    if(bounds.size()>2 || !toCount(bounds[0], minCount))
+        return -1;
+    if(bounds.size()==1)
+        maxCount=minCount;
+    else if(bounds[1].isEmpty())
+        maxCount=-1;
+    else if(!toCount(bounds[1], maxCount))
+        return -1;
+    if(maxCount>=0 && (maxCount<minCount || maxCount==0))
+        return -1;
+    return close;
+}
+
+/**
+ * @brief NDFA::regexToPostfix
+ * @param s
+ * @return 后缀式
+ * 以运算符栈（调度场算法）将正则表达式转换为后缀式，省略的连接运算补为'&'；
+ * 操作符在此处转换为编号，只登记一次。记号的顺序即原先边解析边构造NFA时
+ * 新建子图与处理运算符的顺序，故由后缀式构造的NFA状态编号与之相同。
+ * 字符类“[...]”（如[a-zA-Z_]、[^`]]）整体作为一个操作符，NFA中只占一条边；
+ * 计数重复“{m,n}”在后缀式中展开为子表达式的副本。
+ * 转义未闭合、括号不匹配、运算符缺少操作数（含空串）时设置m_errorStr并返回空的后缀式
+ */
+QList<NDFA::RegexToken> NDFA::regexToPostfix(const QString &s)
 {
     opPriorityMapInit();//运算符优先级初始化
 
-    QStack<NFAGraph> NFAStack;//存NFA子图的栈
+    QList<RegexToken> postfix;//输出的后缀式
     QStack<QChar> opStack;//符号栈
 
     for(int i=0;i<s.size();i++)
@@ -292,15 +298,15 @@ NDFA::NFAGraph NDFA::strToNfa(QString s)
         case '|':
         case '&':
         {
-            pushOpStackProcess(s[i],opStack,NFAStack);
+            pushOpStackProcess(s[i],opStack,postfix);
             break;
         }
         case '*':
         case '+':
         case '?':
         {
-            pushOpStackProcess(s[i],opStack,NFAStack);
-            insConnOp(s,i,opStack,NFAStack);
+            pushOpStackProcess(s[i],opStack,postfix);
+            insConnOp(s,i,opStack,postfix);
             break;
         }
         case '(': opStack.push('(');break;
@@ -309,55 +315,200 @@ NDFA::NFAGraph NDFA::strToNfa(QString s)
             while(!opStack.empty())
             {
                 if(opStack.top() != '(')
-                {
-                    opProcess(opStack.top(),NFAStack);
-                    opStack.pop();
-                }
+                    postfix.append(RegexToken{opStack.pop(), -1});
                 else break;
             }
+            if(opStack.empty())
+            {
+                m_errorStr=QString("第%1个字符处的')'没有匹配的'('").arg(i+1);
+                return QList<RegexToken>();
+            }
             opStack.pop();
-            insConnOp(s,i,opStack,NFAStack);
+            insConnOp(s,i,opStack,postfix);
             break;
         }
         default:
         {
+            //计数重复作用于前面的子表达式，先输出其尚在栈中的单目运算符
+            int minCount, maxCount;
+            int repeatEnd=parseRepeat(s,i,minCount,maxCount);
+            if(repeatEnd>0 && i>0 && !QString("(|&").contains(s[i-1]))//前面须有子表达式
+            {
+                if(minCount>RepeatLimit || maxCount>RepeatLimit)
+                {
+                    m_errorStr=QString("计数重复%1的次数超过上限%2").arg(s.mid(i,repeatEnd-i+1)).arg(RepeatLimit);
+                    return QList<RegexToken>();
+                }
+                while(!opStack.empty() && opStack.top()!='(' && opPriorityMap[opStack.top()]>=opPriorityMap['*'])
+                    postfix.append(RegexToken{opStack.pop(), -1});
+                if(postfixDepth(postfix)<1)
+                {
+                    m_errorStr=QString("计数重复%1前缺少子表达式").arg(s.mid(i,repeatEnd-i+1));
+                    return QList<RegexToken>();
+                }
+                if(!expandRepeat(postfix,minCount,maxCount))
+                {
+                    m_errorStr=QString("计数重复展开后正则表达式过长（超过%1个记号）").arg(PostfixLimit);
+                    return QList<RegexToken>();
+                }
+                i=repeatEnd;
+                insConnOp(s,i,opStack,postfix);
+                break;
+            }
+
             //查看是否为转义字符
             QString tmpStr;
+            int end;
             if(s[i]=='\\')
             {
-                while(s[++i]!='\\')
+                const int escStart=i;
+                while(++i<s.size() && s[i]!='\\')
                 {
-                    if(s[i]=='`')i++;//转义的转义字符，因MiniC中注释符号有反斜杠'\'，用于区分
+                    if(s[i]=='`' && i+1<s.size())i++;//转义的转义字符，因MiniC中注释符号有反斜杠'\'，用于区分
                     tmpStr+=s[i];
                 }
-                m_opCharSet.insert(tmpStr);//顺便加入操作符集合
-                qDebug()<<tmpStr;
-            }
-            else {
-                tmpStr=s[i];
-
-                if(!m_opSet.contains(s[i]))
+                if(i>=s.size())
                 {
-                    m_opCharSet.insert(QString(s[i]));//若是转义字符顺便加入操作符集合
-                    qDebug()<<tmpStr;
+                    m_errorStr=QString("第%1个字符处的转义缺少结尾的'\\'").arg(escStart+1);
+                    return QList<RegexToken>();
                 }
             }
+            else if(s[i]=='[' && (end=classEnd(s,i))>0)
+            {
+                tmpStr=s.mid(i,end-i+1);//字符类以原文登记为操作符
+                i=end;
+            }
+            else tmpStr=s[i];
 
-            NFAGraph n=createNFA(m_NFAStateNum);
-            m_NFAStateNum+=2;
-            //生成NFA子图，加非eps边
-            add(n.startNode,n.endNode,tmpStr);
-
-            NFAStack.push(n);
-            insConnOp(s,i,opStack,NFAStack);
+            postfix.append(RegexToken{QChar(), internSymbol(tmpStr)});
+            insConnOp(s,i,opStack,postfix);
         }
         }
     }
     //读完字符串，运算符站还有元素则将其全部出栈
     while(!opStack.empty())
-        opProcess(opStack.pop(),NFAStack);
+    {
+        if(opStack.top()=='(')
+        {
+            m_errorStr="'('没有匹配的')'";
+            return QList<RegexToken>();
+        }
+        postfix.append(RegexToken{opStack.pop(), -1});
+    }
+    if(postfixDepth(postfix)!=1)
+    {
+        m_errorStr=postfix.isEmpty() ? QString("正则表达式为空") : QString("运算符缺少操作数");
+        return QList<RegexToken>();
+    }
+
+    return postfix;
+}
+
+/**
+ * @brief NDFA::postfixToNfa
+ * @param postfix
+ * @return NFA子图
+ * Thompson构造：操作符新建子图，运算符按opProcess合并栈顶子图；
+ * 后缀式不完整时不构造，返回初态、终态均为-1的子图
+ */
+NDFA::NFAGraph NDFA::postfixToNfa(const QList<RegexToken> &postfix)
+{
+    if(postfixDepth(postfix)!=1)
+    {
+        if(m_errorStr.isEmpty())
+            m_errorStr="运算符缺少操作数";
+        return NFAGraph{-1, -1};
+    }
+    ArenaVector<NFAGraph> NFAStack(&m_arena);//存NFA子图的栈
+    for(const auto &token: postfix)
+    {
+        if(token.op.isNull())
+        {
+            NFAGraph n=createNFA();
+            //生成NFA子图，加非eps边
+            add(n.startState,n.endState,token.symbol);
+            NFAStack.push_back(n);
+        }
+        else
+            opProcess(token.op,NFAStack);
+    }
+    return NFAStack.back();
+}
+
+/**
+ * @brief NDFA::postfixDepth
+ * @param postfix
+ * @return 按后缀式求值后操作数栈中剩余的子表达式数，某运算符缺少操作数时为-1；
+ * 完整的正则表达式恰为1
+ */
+int NDFA::postfixDepth(const QList<RegexToken> &postfix)
+{
+    int depth=0;
+    for(const auto &token: postfix)
+    {
+        if(token.op.isNull())
+            depth++;
+        else if(token.op=='|' || token.op=='&')
+        {
+            if(depth<2)
+                return -1;
+            depth--;
+        }
+        else if(depth<1)
+            return -1;
+    }
+    return depth;
+}
 
-    return NFAStack.top();
+/**
+ * @brief NDFA::expandRepeat
+ * @param postfix
+ * @param minCount
+ * @param maxCount 无上限时为-1
+ * 后缀式末尾的完整子表达式X展开为X连接minCount次，再连接maxCount-minCount个X?；
+ * 无上限时最后一个X改为X+（minCount为0时为X*）。NFA与followpos构造均无需另行处理。
+ * 展开后后缀式超过PostfixLimit个记号时不展开，返回false（嵌套的计数重复按乘积增长）
+ */
+bool NDFA::expandRepeat(QList<RegexToken> &postfix, int minCount, int maxCount)
+{
+    //自末尾向前找出子表达式的起点：操作符使所需的子表达式数减1，双目运算符加1，单目运算符不变
+    int start=postfix.size();
+    for(int need=1;need>0;)
+    {
+        const RegexToken &token=postfix[--start];
+        if(token.op.isNull())
+            need--;
+        else if(token.op=='|' || token.op=='&')
+            need++;
+    }
+    const qint64 copyNum=maxCount<0 ? qMax(minCount, 1) : maxCount;
+    if(start+copyNum*(postfix.size()-start+2)>PostfixLimit)//每个副本至多另加单目与连接两个运算符
+        return false;
+    const QList<RegexToken> operand=postfix.mid(start);
+    postfix.resize(start);
+
+    int copies=0;
+    auto appendCopy=[&](QChar unaryOp){
+        postfix.append(operand);
+        if(!unaryOp.isNull())
+            postfix.append(RegexToken{unaryOp, -1});
+        if(copies++>0)
+            postfix.append(RegexToken{'&', -1});
+    };
+    if(maxCount<0)
+    {
+        for(int k=1;k<minCount;k++)
+            appendCopy(QChar());
+        appendCopy(minCount>0 ? '+' : '*');
+    }
+    else
+    {
+        for(int k=0;k<minCount;k++)
+            appendCopy(QChar());
+        for(int k=minCount;k<maxCount;k++)
+            appendCopy('?');
+    }
+    return true;
 }
 
 /**
@@ -374,25 +525,24 @@ void NDFA::opPriorityMapInit()
     opPriorityMap['?']=3;
 }
 
-void NDFA::insConnOp(QString str, int curState, QStack<QChar> &opStack, QStack<NFAGraph> &NFAStack)
+void NDFA::insConnOp(const QString &str, int curState, QStack<QChar> &opStack, QList<RegexToken> &postfix)
 {
-    //判断是否两元素间加入连接符号，即栈中是否需要加入连接符号
-    if(curState+1<str.size() && (!m_opSet.contains(str[curState+1]) || str[curState+1]=='('))
+    //判断是否两元素间加入连接符号，即栈中是否需要加入连接符号；其后为计数重复时不加
+    int minCount, maxCount;
+    if(curState+1<str.size() && (!m_opSet.contains(str[curState+1]) || str[curState+1]=='(')
+            && parseRepeat(str,curState+1,minCount,maxCount)<0)
     {
-        pushOpStackProcess('&',opStack,NFAStack);
+        pushOpStackProcess('&',opStack,postfix);
     }
 }
 
-void NDFA::pushOpStackProcess(QChar opCh, QStack<QChar> &opStack, QStack<NFAGraph> &NFAStack)
+void NDFA::pushOpStackProcess(QChar opCh, QStack<QChar> &opStack, QList<RegexToken> &postfix)
 {
     while(!opStack.empty())
     {
-        //若栈顶运算符优先级大于当前将进栈元素，则将栈顶元素出栈并处理，再继续循环判断
+        //若栈顶运算符优先级大于当前将进栈元素，则将栈顶元素出栈输出，再继续循环判断
         if(opStack.top()!='(' && opPriorityMap[opStack.top()]>=opPriorityMap[opCh])
-        {
-            opProcess(opStack.top(),NFAStack);
-            opStack.pop();
-        }
+            postfix.append(RegexToken{opStack.pop(), -1});
         else break;
     }
     opStack.push(opCh);
@@ -404,87 +554,89 @@ void NDFA::pushOpStackProcess(QChar opCh, QStack<QChar> &opStack, QStack<NFAGrap
  * @param NFAStack
  * 根据运算符转换NFA处理子函数
  */
-void NDFA::opProcess(QChar opChar, QStack<NFAGraph> &NFAStack)
+void NDFA::opProcess(QChar opChar, ArenaVector<NFAGraph> &NFAStack)
 {
+    auto pop=[&NFAStack](){
+        NFAGraph n=NFAStack.back();
+        NFAStack.pop_back();
+        return n;
+    };
+
     switch(opChar.unicode())
     {
     case '|':
     {
         //或运算处理
-        NFAGraph n1=NFAStack.pop();//先出n1
-        NFAGraph n2=NFAStack.pop();//后出n2
-        NFAGraph n=createNFA(m_NFAStateNum);
-        m_NFAStateNum+=2;
+        NFAGraph n1=pop();//先出n1
+        NFAGraph n2=pop();//后出n2
+        NFAGraph n=createNFA();
 
-        add(n.startNode,n2.startNode);
-        add(n.startNode,n1.startNode);
-        add(n2.endNode,n.endNode);
-        add(n1.endNode,n.endNode);
-        NFAStack.push(n);
+        add(n.startState,n2.startState);
+        add(n.startState,n1.startState);
+        add(n2.endState,n.endState);
+        add(n1.endState,n.endState);
+        NFAStack.push_back(n);
 
         break;
     }
     case '&':
     {
         //与运算处理
-        NFAGraph n1=NFAStack.pop();
-        NFAGraph n2=NFAStack.pop();
+        NFAGraph n1=pop();
+        NFAGraph n2=pop();
 
-        add(n2.endNode,n1.startNode);
+        add(n2.endState,n1.startState);
 
         NFAGraph n;
-        n.startNode=n2.startNode;
-        n.endNode=n1.endNode;
+        n.startState=n2.startState;
+        n.endState=n1.endState;
 
-        NFAStack.push(n);
+        NFAStack.push_back(n);
         break;
     }
     case '*':
     {
         //闭包运算处理
-        NFAGraph n1=NFAStack.pop();
-        NFAGraph n=createNFA(m_NFAStateNum);
-        m_NFAStateNum+=2;
+        NFAGraph n1=pop();
+        NFAGraph n=createNFA();
 
-        add(n.startNode,n.endNode);
-        add(n.startNode,n1.startNode);
-        add(n1.endNode,n1.startNode);
-        add(n1.endNode,n.endNode);
+        add(n.startState,n.endState);
+        add(n.startState,n1.startState);
+        add(n1.endState,n1.startState);
+        add(n1.endState,n.endState);
 
-        NFAStack.push(n);
+        NFAStack.push_back(n);
         break;
     }
     case '+':
     {
         //正闭包运算处理
-        NFANode *newEndNode=&m_NFAStateArr[m_NFAStateNum];
-        m_NFAStateNum++;
+        int newEndState=newNFANode();
 
-        NFAGraph n1=NFAStack.pop();
-        add(n1.endNode,newEndNode);
-        add(n1.endNode,n1.startNode);
+        NFAGraph n1=pop();
+        add(n1.endState,newEndState);
+        add(n1.endState,n1.startState);
 
         NFAGraph n;
-        n.startNode=n1.startNode;
-        n.endNode=newEndNode;
+        n.startState=n1.startState;
+        n.endState=newEndState;
 
-        NFAStack.push(n);
+        NFAStack.push_back(n);
         break;
     }
     case '?':
     {
-        NFANode *newStartNode=&m_NFAStateArr[m_NFAStateNum];
-        m_NFAStateNum++;
+        int newStartState=newNFANode();
 
-        NFAGraph n1=NFAStack.pop();
-        add(newStartNode,n1.startNode);
-        add(newStartNode,n1.endNode);
+        NFAGraph n1=pop();
+        add(newStartState,n1.startState);
+        add(newStartState,n1.endState);
 
         NFAGraph n;
-        n.startNode=newStartNode;
-        n.endNode=n1.endNode;
+        n.startState=newStartState;
+        n.endState=n1.endState;
 
-        NFAStack.push(n);
+        NFAStack.push_back(n);
         break;
     }
     }
@@ -495,30 +647,60 @@ void NDFA::opProcess(QChar opChar, QStack<NFAGraph> &NFAStack)
  * @param tmpSet
  * 求epsilon闭包
  */
-void NDFA::get_e_closure(QSet<int> &tmpSet)
+void NDFA::get_e_closure(StateSet &tmpSet)
 {
-    QQueue<int> q;
-    for(const auto &value: tmpSet)
-        q.push_back(value);
+    m_phaseStats.closureNum++;
+    QList<int> stack=tmpSet.values();//待扩展的状态，顺序无关，用栈即可
 
-    while(!q.empty())
+    while(!stack.empty())
     {
-        int tmpFront=q.front();
-        q.pop_front();
+        int tmpTop=stack.takeLast();
 
-        QSet<int> eTmpSet=m_NFAStateArr[tmpFront].epsToSet;
-        //将通过epsilon到达的节点序号放入集合中
-        for(const auto &value: eTmpSet)
+        //将通过epsilon到达的节点序号放入集合中，目标在CSR数组中连续存放
+        for(int i=m_NFAEpsOff[tmpTop];i<m_NFAEpsOff[tmpTop+1];i++)
         {
+            const int value=m_NFAEpsTo[i];
             if(!tmpSet.contains(value))
             {
                 tmpSet.insert(value);
-                q.push_back(value);
+                stack.push_back(value);
             }
         }
     }
 }
 
+/**
+ * @brief NDFA::stateClosure
+ * @param state
+ * @return 状态state的epsilon闭包
+ * 首次访问时求出并缓存，子集构造中同一目标状态的闭包只求一次，
+ * 之后以位图并集合并
+ */
+const StateSet &NDFA::stateClosure(int state)
+{
+    if(m_NFAClosureArr.size()<m_NFAStateNum)
+        m_NFAClosureArr.resize(m_NFAStateNum);
+
+    StateSet &closure=m_NFAClosureArr[state];
+    if(closure.isEmpty())//闭包至少包含自身，为空即未求过
+    {
+        closure=StateSet(m_NFAStateNum, &m_arena);
+        closure.insert(state);
+        get_e_closure(closure);
+    }
+    return closure;
+}
+
+/**
+ * @brief NDFA::precomputeClosures
+ * 求出所有NFA状态的epsilon闭包，之后子集构造只需做位图并集
+ */
+void NDFA::precomputeClosures()
+{
+    for(int state=0;state<m_NFAStateNum;state++)
+        stateClosure(state);
+}
+
 /**
  * @brief NDFA::getStateId
  * @param set
@@ -526,76 +708,76 @@ void NDFA::get_e_closure(QSet<int> &tmpSet)
  * @return i
  * 查询当前DFA节点号cur属于mDFA节点的状态集号
  */
-int NDFA::getStateId(QSet<int> set[], int cur)
+int NDFA::getStateId(const QList<QSet<int>> &set, int cur)
 {
     for(int i=0;i<m_mDFAStateNum;i++)
     {
         if(set[i].contains(cur))
             return i;
     }
+    return -1;
 }
 
 /**
  * @brief NDFA::genLexCase
- * @param tmpList
+ * @param classList
  * @param codeStr
  * @param idx
  * @param flag
- * @return
- *生成Lexer代码的核心子函数
+ * @return 是否含“~”边
+ *生成Lexer代码的核心子函数，每个字符类生成一个case，“~”边留给default处理
  */
-bool NDFA::genLexCase(QList<QString> tmpList, QString &codeStr, int idx, bool flag)
+bool NDFA::genLexCase(QList<int> classList, QString &codeStr, int idx, bool flag)
 {
     bool rFlag=false;
-    for(int i=0;i<tmpList.size();i++)
+    const QList<int> letterClasses=symbolClasses("letter");
+    const QList<int> digitClasses=symbolClasses("digit");
+    for(const auto &c: classList)
     {
-        QString tmpKey=tmpList[i];
-        //字母情况
-        if(tmpKey=="letter")
-        {
-            for(int j=0;j<26;j++)
-            {
-                codeStr+="\t\t\tcase \'"+QString(char('a'+j))+"\':\n";
-                codeStr+="\t\t\tcase \'"+QString(char('A'+j))+"\':\n";
-            }
-            codeStr.chop(1);//去掉末尾字符
-            if(flag)codeStr+="isIdentifier = true; ";
-        }
-        else if(tmpKey=="digit")
-        {
-            //数字情况
-            for(int j=0;j<10;j++)
-            {
-                codeStr+="\t\t\tcase \'"+QString::number(j)+"\':\n";
-            }
-            codeStr.chop(1);
-            if(flag)codeStr+="isDigit = true; ";
-        }
-        else if(tmpKey=="~")
+        if(c==m_otherClass)
         {
             rFlag=true;
             continue;
         }
-        else codeStr+="\t\t\tcase \'"+tmpKey+"\':";
-
-        if(flag)codeStr+="state = "+QString::number(m_mDFANodeArr[idx].mDFAEdgesMap[tmpKey])+"; ";
+        QString label=classLabel(c);
+        label.replace("*/","* /");//避免提前结束注释
+        codeStr+="\t\t\tcase "+QString::number(c)+": /* "+label+" */ ";
+        if(flag)
+        {
+            if(letterClasses.contains(c))codeStr+="isIdentifier = true; ";
+            if(digitClasses.contains(c))codeStr+="isDigit = true; ";
+            codeStr+="state = "+QString::number(m_mDFATrans[idx*m_classNum+c])+"; ";
+        }
         codeStr+="break;\n";
     }
     return rFlag;
 }
 
+/**
+ * @brief NDFA::newNFANode
+ * @return 新节点状态号
+ * 在NFA状态数组末尾追加一个初始化的节点
+ */
+int NDFA::newNFANode()
+{
+    NFANode node;
+    node.init();
+    node.stateNum=m_NFAStateNum;
+    m_NFAStateArr.append(node);
+    return m_NFAStateNum++;
+}
+
 /**
  * @brief NDFA::createNFA
- * @param stateN
  * @return n
  * 建立一个初始化的NFA子图，包含开始和结尾两NFA节点
  */
-NDFA::NFAGraph NDFA::createNFA(int stateN)
+NDFA::NFAGraph NDFA::createNFA()
 {
     NFAGraph n;
 
-    n.startNode=&m_NFAStateArr[stateN];
-    n.endNode=&m_NFAStateArr[stateN+1];
+    n.startState=newNFANode();
+    n.endState=newNFANode();
 
     return n;
 }
@@ -604,14 +786,14 @@ NDFA::NFAGraph NDFA::createNFA(int stateN)
  * @brief NDFA::add
  * @param n1
  * @param n2
- * @param ch
- * n1--ch-->n2
- * NFA节点n1与n2间添加一条非epsilon边，操作符为ch
+ * @param symbol
+ * n1--symbol-->n2
+ * NFA节点n1与n2间添加一条非epsilon边，symbol为操作符编号
  */
-void NDFA::add(NDFA::NFANode *n1, NDFA::NFANode *n2, QString ch)
+void NDFA::add(int n1, int n2, int symbol)
 {
-    n1->value = ch;
-    n1->toState = n2->stateNum;
+    m_NFAStateArr[n1].symbol = symbol;
+    m_NFAStateArr[n1].toState = n2;
 }
 
 /**
@@ -619,134 +801,1171 @@ void NDFA::add(NDFA::NFANode *n1, NDFA::NFANode *n2, QString ch)
  * @param n1
  * @param n2
  * n1--eps->n2
- * NFA节点n1与n2间添加一条epsilon边，信息记录于n1节点中
+ * NFA节点n1与n2间添加一条epsilon边，记入边表，构造完成后由freezeNFA整理
+ * Thompson构造不会在同一对节点间重复加边，故不去重
  */
-void NDFA::add(NFANode *n1, NFANode *n2)
+void NDFA::add(int n1, int n2)
 {
-    n1->epsToSet.insert(n2->stateNum);
-    //qDebug()<<"addEps:"<<n2->stateNum;
+    m_NFAEpsFrom.append(n1);
+    m_NFAEpsTo.append(n2);
+    //qDebug()<<"addEps:"<<n2;
+}
+
+/**
+ * @brief NDFA::clearNFA
+ * 清除NFA（followpos构造时为位置与followpos集合）、操作符表与规则表；
+ * 正则表达式有误时调用，不保留已构造的部分
+ */
+void NDFA::clearNFA()
+{
+    m_NFAStateNum=0;
+    m_opCharList.clear();
+    m_opCharIdx.clear();
+    m_byteClass.clear();
+    m_classBytes.clear();
+    m_symbolClasses.clear();
+    m_classNum=0;
+    m_otherClass=-1;
+    m_multiRule=false;
+    m_ruleNames.clear();
+    m_ruleSkip.clear();
+    m_NFAAcceptStates.clear();
+    m_NFAG.startState=-1;
+    m_NFAG.endState=-1;
+    m_NFAStateArr.clear();
+    m_NFAEpsFrom.clear();
+    m_NFAEpsTo.clear();
+    m_NFAEpsOff.clear();
+    m_NFAClosureArr.clear();
+    m_posSymbol.clear();
+    m_followpos.clear();
+    m_ruleEndPos.clear();
+    m_startPos=StateSet();//赋值同时换下其内存池
+    clearDFA();
+}
+
+const QString &NDFA::errorString() const
+{
+    return m_errorStr;
 }
 
 /**
  * @brief NDFA::reg2NFA
  * @param regStr
+ * @return 是否成功，失败时原因由errorString取得
  * 将正则表达式转换为NFA的主函数
  */
-void NDFA::reg2NFA(QString regStr)
+bool NDFA::reg2NFA(QString regStr)
 {
-    m_NFAG=strToNfa(regStr);//调用转换函数
+    QElapsedTimer timer;
+    timer.start();
+    const qint64 arenaAllocs=m_arena.stats().allocations;
+    m_errorStr.clear();
+    QList<RegexToken> postfix=regexToPostfix(regStr);
+    if(!m_errorStr.isEmpty())
+    {
+        clearNFA();
+        return false;
+    }
+    m_ruleNames.append("Token");//单条正则表达式即一条规则
+    m_ruleSkip.append(false);
+    if(m_constructEngine==ThompsonConstruct)
+    {
+        m_NFAG=postfixToNfa(postfix);//调用转换函数
+        setAcceptRule(m_NFAG.endState,0);
+        freezeNFA();
+    }
+    buildSymbolClasses();//确定化之前先压缩字母表
+    if(m_constructEngine==FollowposConstruct)
+        computeFollowpos({postfix});
+    recordNFAStats();
+    recordArenaStats(NFAPhase, arenaAllocs);
+    m_phaseStats.phaseNs[NFAPhase]=timer.nsecsElapsed();
+    return true;
 }
 
 /**
- * @brief NDFA::NFA2DFA
- * 将NFA转换为DFA的主函数
- */
-void NDFA::NFA2DFA()
-{    
-    QSet<int> tmpSet;
-    tmpSet.insert(m_NFAG.startNode->stateNum);//将NFA初态节点放入集合
-    get_e_closure(tmpSet);//求NFA初态节点的epsilon闭包得到DFA初态
-    m_DFAStateArr[m_DFAStateNum].NFANodeSet=tmpSet;//从初态开始
-    if(tmpSet.contains(m_NFAG.endNode->stateNum))
-        m_DFAEndStateSet.insert(m_DFAStateNum);
-    m_DFAStateNum++;
-
-    QSet<QSet<int>> DFAStatesSet;//存储DFA节点包含的序号
-    DFAStatesSet.insert(tmpSet);//将出台包含的序号集放入集合
-    QQueue<DFANode> q;
-    q.push_back(m_DFAStateArr[0]);//初态入队
-
-    while(!q.empty())
+ * @brief NDFA::rules2NFA
+ * @param rules
+ * 多条词法规则合并为一个NFA：新建初态，以epsilon边连向各规则子图，各子图终态记录规则号。
+ * 关键字（setKeywordStr设置）作为字面规则排在所有规则之前，优先级最高；
+ * 规则号越小优先级越高，同一DFA状态含多条规则的终态时取优先级最高者。
+ * followpos构造时不建NFA，各规则（含关键字）转换为后缀式后求followpos。
+ * 某条规则的正则表达式有误时返回false，原因（含规则名）由errorString取得
+ */
+bool NDFA::rules2NFA(const QList<LexRule> &rules)
+{
+    QElapsedTimer timer;
+    timer.start();
+    const qint64 arenaAllocs=m_arena.stats().allocations;
+    m_errorStr.clear();
+    m_multiRule=true;
+    const bool thompson=m_constructEngine==ThompsonConstruct;
+    QList<QList<RegexToken>> rulePostfix;
+    if(thompson)
+        m_NFAG.startState=newNFANode();
+    else
+        m_NFAG.startState=-1;
+    m_NFAG.endState=-1;//多规则时没有唯一的终态
+
+    QStringList keywordList;
+    for(const auto &keyword: m_reg_keyword_str.split('|'))
+        if(!keyword.isEmpty() && !keywordList.contains(keyword))
+            keywordList.append(keyword);
+    for(const auto &keyword: keywordList)
     {
-        DFANode *t_DFANode=&q.front();//取出队列中一个DFA节点
-        q.pop_front();
-
-        tmpSet=t_DFANode->NFANodeSet;//取出该DFA节点所包含的序号集
-        int t_curState=t_DFANode->stateNum;//记录当前DFA节点序号
+        if(thompson)
+        {
+            NFAGraph n=literalToNfa(keyword);
+            add(m_NFAG.startState,n.startState);
+            setAcceptRule(n.endState,m_ruleNames.size());
+        }
+        else
+            rulePostfix.append(literalToPostfix(keyword));
+        m_ruleNames.append("Keyword");
+        m_ruleSkip.append(false);
+    }
 
-        //遍历操作符集
-        for(const auto &ch: m_opCharSet)
+    for(const auto &rule: rules)
+    {
+        QList<RegexToken> postfix=regexToPostfix(rule.regex);
+        if(!m_errorStr.isEmpty())
         {
-            QSet<int> chToSet;//节点的（出边为ch）的集合
-            for(const auto &t_state: tmpSet)//遍历当前序号集合中的所有序号
-            {
-                //找出所有这样的序号
-                if(m_NFAStateArr[t_state].value==ch)
-                    chToSet.insert(m_NFAStateArr[t_state].toState);
-            }
+            m_errorStr=QString("规则%1：%2").arg(rule.name, m_errorStr);
+            clearNFA();
+            return false;
+        }
+        if(thompson)
+        {
+            NFAGraph n=postfixToNfa(postfix);
+            add(m_NFAG.startState,n.startState);
+            setAcceptRule(n.endState,m_ruleNames.size());
+        }
+        else
+            rulePostfix.append(postfix);
+        m_ruleNames.append(rule.name);
+        m_ruleSkip.append(rule.skip);
+    }
 
-            if(chToSet.empty())//若找不到这样的节点，则说明该边需要被丢弃
-                continue;
-            get_e_closure(chToSet);//求上得的序号集合的epsilon闭包
+    if(thompson)
+        freezeNFA();
+    buildSymbolClasses();
+    if(!thompson)
+        computeFollowpos(rulePostfix);
+    recordNFAStats();
+    recordArenaStats(NFAPhase, arenaAllocs);
+    m_phaseStats.phaseNs[NFAPhase]=timer.nsecsElapsed();
+    return true;
+}
 
-            if(!DFAStatesSet.contains(chToSet))
-            {
-                //若该DFA状态节点不存在
-                //新建DFA节点
-                m_DFAStateArr[m_DFAStateNum].NFANodeSet=chToSet;//chToSet--ch-->xxx
-                //若包含NFA终态
-                if(chToSet.contains(m_NFAG.endNode->stateNum))
-                    m_DFAEndStateSet.insert(m_DFAStateNum);
-                //更新原节点的信息
-                m_DFAStateArr[t_curState].DFAEdgeMap[ch]=m_DFAStateNum;//当前DFA节点能通过ch去到的新DFA状态
-                DFAStatesSet.insert(chToSet);
-                q.push_back(m_DFAStateArr[m_DFAStateNum++]);//节点入队后自增，DFA节点新增，寻找更多的
-            }
-            else
-            {   //若该DFA状态节点存在
-                for(int i=0;i<m_DFAStateNum;i++)
-                {
-                    if(m_DFAStateArr[i].NFANodeSet==chToSet)
-                    {
-                        //更新当前DFA节点状态
-                        m_DFAStateArr[t_curState].DFAEdgeMap[ch]=i;//当前DFA节点能通过ch边去到的DFA状态发生变更
-                        break;
-                    }
-                }
-            }
-        }
+/**
+ * @brief NDFA::freezeNFA
+ * 按起点对epsilon边表做计数排序，得到CSR形式的偏移数组与目标数组，
+ * 求闭包时每个状态的epsilon目标连续存放，同一起点的边保持加入顺序
+ */
+void NDFA::freezeNFA()
+{
+    m_NFAEpsOff.fill(0, m_NFAStateNum+1);
+    for(const auto &from: m_NFAEpsFrom)
+        m_NFAEpsOff[from+1]++;
+    for(int state=0;state<m_NFAStateNum;state++)
+        m_NFAEpsOff[state+1]+=m_NFAEpsOff[state];
+
+    QList<int> next=m_NFAEpsOff;//各起点下一条边的写入位置
+    QList<int> epsTo(m_NFAEpsTo.size());
+    for(int i=0;i<m_NFAEpsFrom.size();i++)
+        epsTo[next[m_NFAEpsFrom[i]]++]=m_NFAEpsTo[i];
+    m_NFAEpsTo.swap(epsTo);
+    m_NFAEpsFrom.clear();
+    m_NFAEpsFrom.squeeze();
+}
+
+/**
+ * @brief NDFA::recordNFAStats
+ * 统计NFA的状态数、边数与占用内存
+ */
+void NDFA::recordNFAStats()
+{
+    m_phaseStats.NFAStateNum=m_NFAStateNum;
+    m_phaseStats.positionNum=m_posSymbol.size();
+    m_phaseStats.followposNum=0;
+    for(const auto &follow: m_followpos)
+        m_phaseStats.followposNum+=follow.count();
+    m_phaseStats.symbolNum=m_opCharList.size();
+    m_phaseStats.classNum=m_classNum;
+    m_phaseStats.ruleNum=m_ruleNames.size();
+    m_phaseStats.NFAEdgeNum=0;
+    m_phaseStats.NFAEpsEdgeNum=m_NFAEpsTo.size();
+    for(int state=0;state<m_NFAStateNum;state++)
+    {
+        if(m_NFAStateArr[state].toState>=0)
+            m_phaseStats.NFAEdgeNum++;
     }
+    m_phaseStats.NFABytes=qint64(m_NFAStateNum)*sizeof(NFANode)
+            +qint64(m_NFAEpsOff.size()+m_NFAEpsTo.size())*sizeof(int)//epsilon边CSR数组
+            +qint64(m_posSymbol.size())*(sizeof(int)+(m_posSymbol.size()+63)/64*sizeof(quint64));//followpos位图
+}
 
+/**
+ * @brief NDFA::recordArenaStats
+ * @param phase
+ * @param allocsBefore 阶段开始时内存池的分配次数
+ * 分配字节数为自init以来的累计，块数与其字节数为阶段结束时仍占用的系统内存
+ */
+void NDFA::recordArenaStats(Phase phase, qint64 allocsBefore)
+{
+    const LexArena::Stats &stats=m_arena.stats();
+    m_phaseStats.arenaAllocs[phase]=stats.allocations-allocsBefore;
+    m_phaseStats.arenaBytes=stats.bytes;
+    m_phaseStats.arenaBlocks=stats.blocks;
+    m_phaseStats.arenaBlockBytes=stats.blockBytes;
 }
 
 /**
- * @brief NDFA::DFA2mDFA
- * DFA的最小化
+ * @brief NDFA::literalToNfa
+ * @param literal
+ * @return NFA子图
+ * 字面串逐字符连接成NFA，字符不经正则表达式解析
  */
-void NDFA::DFA2mDFA()
+NDFA::NFAGraph NDFA::literalToNfa(const QString &literal)
 {
-    m_mDFAStateNum=1;//未划分，状态数量为1
-    for(int i=0;i<m_DFAStateNum;i++)//遍历DFA状态集合
-    {   //若DFA状态非终态
-        if(!m_DFAStateArr[i].NFANodeSet.contains(m_NFAG.endNode->stateNum))
-        {   //暂时都划分到非终态集合
-            m_dividedSet[1].insert(m_DFAStateArr[i].stateNum);//非终态集合
-            m_mDFAStateNum=2;//设为2，终态与非终态
+    NFAGraph n;
+    n.startState=newNFANode();
+    n.endState=n.startState;
+    for(const auto &ch: literal)
+    {
+        int next=newNFANode();
+        add(n.endState,next,internSymbol(QString(ch)));
+        n.endState=next;
+    }
+    return n;
+}
 
-        }
-        else m_dividedSet[0].insert(m_DFAStateArr[i].stateNum);//否则加入终态划分
+/**
+ * @brief NDFA::literalToPostfix
+ * @param literal
+ * @return 后缀式
+ * 字面串逐字符连接，与literalToNfa相同，字符不经正则表达式解析
+ */
+QList<NDFA::RegexToken> NDFA::literalToPostfix(const QString &literal)
+{
+    QList<RegexToken> postfix;
+    for(int i=0;i<literal.size();i++)
+    {
+        postfix.append(RegexToken{QChar(), internSymbol(QString(literal[i]))});
+        if(i>0)
+            postfix.append(RegexToken{'&', -1});
     }
+    return postfix;
+}
 
-    bool divFlag=true;//表示是否有新状态划分出来，有则真，无则假
-    while(divFlag)
+/**
+ * @brief NDFA::computeFollowpos
+ * @param rulePostfix 规则号→后缀式
+ * 按后缀式自底向上求各子表达式的nullable、firstpos、lastpos（即语法树的后序遍历，
+ * 不显式建树），遇连接与闭包时登记followpos；每条规则末尾连接一个结束标记位置，
+ * 各规则的firstpos之并为DFA初态
+ */
+void NDFA::computeFollowpos(const QList<QList<RegexToken>> &rulePostfix)
+{
+    //子表达式的nullable、firstpos、lastpos
+    struct PosNode
     {
-        //遍历mDFA状态
-        divFlag=false;
-        for(int i=0;i<m_mDFAStateNum;i++)
+        bool nullable;
+        StateSet firstPos;
+        StateSet lastPos;
+    };
+
+    int posNum=rulePostfix.size();//结束标记
+    for(const auto &postfix: rulePostfix)
+        for(const auto &token: postfix)
+            if(token.op.isNull())
+                posNum++;
+    m_posSymbol.clear();
+    m_posSymbol.reserve(posNum);
+    m_followpos=QList<StateSet>(posNum, StateSet(posNum, &m_arena));
+    m_ruleEndPos.clear();
+    m_startPos=StateSet(posNum, &m_arena);
+
+    auto addFollow=[this](const StateSet &from, const StateSet &to){
+        for(const auto &pos: from)
+            m_followpos[pos].unite(to);
+    };
+
+    ArenaVector<PosNode> nodeStack(&m_arena);
+    for(const auto &postfix: rulePostfix)
+    {
+        for(const auto &token: postfix)
         {
-            //遍历操作符集
-            for(const auto &opChar: m_opCharSet)
+            if(token.op.isNull())
+            {
+                StateSet pos(posNum, &m_arena);
+                pos.insert(m_posSymbol.size());
+                m_posSymbol.append(token.symbol);
+                nodeStack.push_back(PosNode{false, pos, pos});
+                continue;
+            }
+            switch(token.op.unicode())
+            {
+            case '|':
+            {
+                PosNode n1=std::move(nodeStack.back());
+                nodeStack.pop_back();
+                PosNode &n2=nodeStack.back();
+                n2.nullable=n2.nullable || n1.nullable;
+                n2.firstPos.unite(n1.firstPos);
+                n2.lastPos.unite(n1.lastPos);
+                break;
+            }
+            case '&':
+            {
+                PosNode n1=std::move(nodeStack.back());
+                nodeStack.pop_back();
+                PosNode &n2=nodeStack.back();//n2在前，n1在后
+                addFollow(n2.lastPos, n1.firstPos);
+                if(n2.nullable)
+                    n2.firstPos.unite(n1.firstPos);
+                if(n1.nullable)
+                    n2.lastPos.unite(n1.lastPos);
+                else
+                    n2.lastPos=n1.lastPos;
+                n2.nullable=n2.nullable && n1.nullable;
+                break;
+            }
+            case '*':
+            case '+':
+            {
+                PosNode &n1=nodeStack.back();
+                addFollow(n1.lastPos, n1.firstPos);
+                if(token.op=='*')
+                    n1.nullable=true;
+                break;
+            }
+            case '?':
+                nodeStack.back().nullable=true;
+                break;
+            }
+        }
+
+        //规则末尾连接结束标记
+        PosNode rule=std::move(nodeStack.back());
+        nodeStack.pop_back();
+        const int endPos=m_posSymbol.size();
+        m_posSymbol.append(-1);
+        m_ruleEndPos.append(endPos);
+        for(const auto &pos: rule.lastPos)
+            m_followpos[pos].insert(endPos);
+        m_startPos.unite(rule.firstPos);
+        if(rule.nullable)
+            m_startPos.insert(endPos);
+    }
+}
+
+/**
+ * @brief NDFA::setAcceptRule
+ * @param state
+ * @param rule
+ * 规则号按递增顺序登记，m_NFAAcceptStates因而按优先级排列
+ */
+void NDFA::setAcceptRule(int state, int rule)
+{
+    m_NFAStateArr[state].acceptRule=rule;
+    m_NFAAcceptStates.append(state);
+}
+
+/**
+ * @brief NDFA::acceptLabel
+ * @param rule
+ * @return 终态的显示文字，多规则时附上规则名
+ */
+QString NDFA::acceptLabel(int rule) const
+{
+    if(!m_multiRule || rule<0)
+        return "终态";
+    return "终态 "+m_ruleNames[rule];
+}
+
+/**
+ * @brief NDFA::isRuleFile
+ * @param lines
+ * @return 首个非空行为%rules时为多规则格式，否则为“第一行正则表达式、第二行关键字”的原格式
+ */
+bool NDFA::isRuleFile(const QStringList &lines)
+{
+    for(const auto &line: lines)
+        if(!line.trimmed().isEmpty())
+            return line.trimmed()=="%rules";
+    return false;
+}
+
+/**
+ * @brief NDFA::parseRules
+ * @param lines
+ * @param rules
+ * @param keywordStr
+ * @param errorStr
+ * @return 是否解析成功
+ * 多规则格式：
+ *   %rules                   首行标记
+ *   # ...                    注释
+ *   %keyword if|then|else    关键字，可出现多次
+ *   NAME regex               一条规则，名称与正则表达式以空白分隔，先出现者优先
+ *   %skip NAME regex         识别但不输出的规则（如注释）
+ */
+bool NDFA::parseRules(const QStringList &lines, QList<LexRule> &rules, QString &keywordStr, QString &errorStr)
+{
+    rules.clear();
+    keywordStr.clear();
+    bool header=false;
+    for(int i=0;i<lines.size();i++)
+    {
+        QString line=lines[i].trimmed();
+        if(line.isEmpty() || line.startsWith('#'))
+            continue;
+        if(!header)
+        {
+            if(line!="%rules")
+            {
+                errorStr="缺少%rules标记";
+                return false;
+            }
+            header=true;
+            continue;
+        }
+
+        //指令须为完整的词，其后为空白或行尾
+        QString directive;
+        if(line.startsWith('%'))
+        {
+            int end=0;
+            while(end<line.size() && !line[end].isSpace())
+                end++;
+            directive=line.left(end);
+            line=line.mid(end).trimmed();
+        }
+
+        if(directive=="%keyword")
+        {
+            if(!line.isEmpty())
+                keywordStr+=(keywordStr.isEmpty() ? "" : "|")+line;
+            continue;
+        }
+
+        LexRule rule;
+        rule.skip=false;
+        if(directive=="%skip")
+            rule.skip=true;
+        else if(!directive.isEmpty())
+        {
+            errorStr=QString("第%1行：未知的指令").arg(i+1);
+            return false;
+        }
+
+        int sep=0;
+        while(sep<line.size() && !line[sep].isSpace())
+            sep++;
+        rule.name=line.left(sep);
+        rule.regex=line.mid(sep).trimmed();
+        if(rule.name.isEmpty() || rule.regex.isEmpty())
+        {
+            errorStr=QString("第%1行：规则应为“名称 正则表达式”").arg(i+1);
+            return false;
+        }
+        rules.append(rule);
+    }
+    if(rules.isEmpty() && keywordStr.isEmpty())
+    {
+        errorStr="没有任何规则";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief classBytes
+ * @param symbol 字符类“[...]”：开头的^表示取反，a-z为区间，`转义下一个字符（`]、`-、`^、``）
+ * @return 字符类匹配的字节，递增；256以上的字符忽略
+ */
+static QList<int> classBytes(const QString &symbol)
+{
+    QList<bool> member(256, false);
+    const int last=symbol.size()-1;//结尾的']'
+    int i=1;
+    const bool negate=i<last && symbol[i]=='^';
+    if(negate)
+        i++;
+    auto readChar=[&symbol, &i, last](){
+        if(symbol[i]=='`' && i+1<last)
+            i++;
+        return int(symbol[i++].unicode());
+    };
+    while(i<last)
+    {
+        const int lo=readChar();
+        int hi=lo;
+        if(i+1<last && symbol[i]=='-')
+        {
+            i++;
+            hi=readChar();
+        }
+        for(int b=lo;b<=hi && b<256;b++)
+            member[b]=true;
+    }
+
+    QList<int> bytes;
+    for(int b=0;b<256;b++)
+        if(member[b]!=negate)
+            bytes<<b;
+    return bytes;
+}
+
+/**
+ * @brief symbolBytes
+ * @param symbol
+ * @return 操作符可匹配的字节
+ * letter、digit为字母、数字，单个字符为其自身，“[...]”为字符类所含的字节；
+ * “~”及其它多字符操作符不对应具体字节
+ */
+static QList<int> symbolBytes(const QString &symbol)
+{
+    QList<int> bytes;
+    if(symbol=="letter")
+    {
+        for(int j=0;j<26;j++)
+            bytes<<'A'+j;
+        for(int j=0;j<26;j++)
+            bytes<<'a'+j;
+    }
+    else if(symbol=="digit")
+    {
+        for(int j=0;j<10;j++)
+            bytes<<'0'+j;
+    }
+    else if(symbol.size()==1 && symbol!="~" && symbol[0].unicode()<256)
+        bytes<<symbol[0].unicode();
+    else if(symbol.size()>=2 && symbol.startsWith('[') && symbol.endsWith(']'))
+        bytes=classBytes(symbol);
+    return bytes;
+}
+
+/**
+ * @brief NDFA::internSymbol
+ * @param symbol
+ * @return 操作符编号
+ * 操作符按首次出现的顺序编号，之后各阶段只使用编号
+ */
+int NDFA::internSymbol(const QString &symbol)
+{
+    auto it=m_opCharIdx.constFind(symbol);
+    if(it!=m_opCharIdx.constEnd())
+        return it.value();
+    m_opCharList.append(symbol);
+    m_opCharIdx.insert(symbol, m_opCharList.size()-1);
+    return m_opCharList.size()-1;
+}
+
+/**
+ * @brief NDFA::buildSymbolClasses
+ * 字母表压缩：被同一组操作符覆盖的字节在自动机中的转换完全相同，归为一个字符类。
+ * 字符类按最小字节排序编号，不对应具体字节的多字符操作符各自成类，
+ * 未被任何操作符覆盖的字节归入最后一类，“~”边也记在该类上（生成代码中即default分支）
+ */
+void NDFA::buildSymbolClasses()
+{
+    //各字节被哪些操作符覆盖（签名）
+    QList<QList<int>> byteSig(256);
+    QList<int> opaqueList;
+    for(int i=0;i<m_opCharList.size();i++)
+    {
+        if(m_opCharList[i]=="~")
+            continue;
+        QList<int> bytes=symbolBytes(m_opCharList[i]);
+        if(bytes.isEmpty())
+            opaqueList.append(i);
+        for(const auto &b: bytes)
+            byteSig[b].append(i);
+    }
+
+    //签名相同的字节归为同一类
+    QHash<QList<int>, int> sigClass;
+    m_byteClass=QList<int>(256, -1);
+    m_classBytes.clear();
+    for(int b=0;b<256;b++)
+    {
+        if(byteSig[b].isEmpty())
+            continue;
+        auto it=sigClass.constFind(byteSig[b]);
+        int c;
+        if(it==sigClass.constEnd())
+        {
+            c=m_classBytes.size();
+            sigClass.insert(byteSig[b], c);
+            m_classBytes.append(QList<int>());
+        }
+        else c=it.value();
+        m_byteClass[b]=c;
+        m_classBytes[c].append(b);
+    }
+
+    m_symbolClasses=QList<QList<int>>(m_opCharList.size());
+    for(const auto &symbol: opaqueList)
+    {
+        m_symbolClasses[symbol].append(m_classBytes.size());
+        m_classBytes.append(QList<int>());
+    }
+
+    m_otherClass=m_classBytes.size();
+    m_classBytes.append(QList<int>());
+    for(int b=0;b<256;b++)
+        if(m_byteClass[b]<0)
+        {
+            m_byteClass[b]=m_otherClass;
+            m_classBytes[m_otherClass].append(b);
+        }
+    m_classNum=m_classBytes.size();
+
+    //各操作符覆盖的字符类
+    for(int i=0;i<m_opCharList.size();i++)
+    {
+        if(m_opCharList[i]=="~")
+        {
+            m_symbolClasses[i].append(m_otherClass);
+            continue;
+        }
+        QList<int> &classes=m_symbolClasses[i];
+        for(const auto &b: symbolBytes(m_opCharList[i]))
+            if(!classes.contains(m_byteClass[b]))
+                classes.append(m_byteClass[b]);
+    }
+}
+
+/**
+ * @brief NDFA::symbolClasses
+ * @param symbol
+ * @return 操作符覆盖的字符类号，正则表达式中未出现该操作符时为空
+ */
+QList<int> NDFA::symbolClasses(const QString &symbol) const
+{
+    int id=m_opCharIdx.value(symbol, -1);
+    return id<0 ? QList<int>() : m_symbolClasses[id];
+}
+
+/**
+ * @brief NDFA::classLabel
+ * @param classId
+ * @return 字符类的显示名
+ * 与某个操作符恰好覆盖相同字节时显示该操作符，否则显示所含字节的区间
+ */
+QString NDFA::classLabel(int classId) const
+{
+    if(classId==m_otherClass)
+        return "~";
+    for(int i=0;i<m_symbolClasses.size();i++)
+        if(m_symbolClasses[i].size()==1 && m_symbolClasses[i][0]==classId)
+            return m_opCharList[i];
+
+    const QList<int> &bytes=m_classBytes[classId];
+    auto byteStr=[](int b){
+        return (b>32 && b<127) ? QString(QChar(b)) : "\\x"+QString::number(b,16);
+    };
+    QString label="[";
+    for(int i=0;i<bytes.size();)
+    {
+        int j=i;
+        while(j+1<bytes.size() && bytes[j+1]==bytes[j]+1)
+            j++;
+        label+=byteStr(bytes[i]);
+        if(j>i)label+="-"+byteStr(bytes[j]);
+        i=j+1;
+    }
+    return label+"]";
+}
+
+/**
+ * @brief NDFA::NFA2DFA
+ * @return 是否完成（被中止时不保留已构造的部分）
+ * 将NFA转换为DFA的主函数：followpos构造时由位置集合构造，否则按线程数选择逐状态或按层并行的子集构造，
+ * 并记录统计信息
+ */
+bool NDFA::NFA2DFA()
+{
+    QElapsedTimer timer;
+    timer.start();
+    clearDFA();
+    const qint64 arenaAllocs=m_arena.stats().allocations;
+    bool completed;
+    if(m_constructEngine==FollowposConstruct)
+        completed=NFA2DFAFollowpos();
+    else
+        completed=m_determinizeThreads>1 ? NFA2DFAParallel() : NFA2DFASerial();
+    if(!completed)
+    {
+        clearDFA();//只构造了一部分，丢弃
+        recordArenaStats(DFAPhase, arenaAllocs);
+        m_phaseStats.phaseNs[DFAPhase]=timer.nsecsElapsed();
+        return false;
+    }
+
+    m_phaseStats.DFAStateNum=m_DFAStateNum;
+    m_phaseStats.DFAEdgeNum=0;
+    for(const auto &to: m_DFATrans)
+        if(to>=0)
+            m_phaseStats.DFAEdgeNum++;
+    const int setBits=m_constructEngine==FollowposConstruct ? m_posSymbol.size() : m_NFAStateNum;
+    const qint64 setBytes=(setBits+63)/64*sizeof(quint64);//一个状态集位图
+    m_phaseStats.DFABytes=qint64(m_DFATrans.size())*sizeof(int)
+            +qint64(m_DFAStateNum)*(sizeof(DFANode)+setBytes)
+            +qint64(m_NFAClosureArr.size())*setBytes;
+    recordArenaStats(DFAPhase, arenaAllocs);
+    m_phaseStats.phaseNs[DFAPhase]=timer.nsecsElapsed();
+    return completed;
+}
+
+/**
+ * @brief NDFA::clearDFA
+ * 清除上一次确定化的结果（及其最小化结果），同一NFA可重新确定化
+ */
+void NDFA::clearDFA()
+{
+    m_DFAStateNum=0;
+    m_DFAStateArr.clear();
+    m_DFATrans.clear();
+    m_DFAAccept.clear();
+    m_DFAEndStateSet.clear();
+    m_phaseStats.DFAIndexLookups=0;
+    m_phaseStats.DFAIndexInserts=0;
+    clearMDFA();
+}
+
+/**
+ * @brief NDFA::clearMDFA
+ * 清除上一次最小化的结果
+ */
+void NDFA::clearMDFA()
+{
+    m_mDFAStateNum=0;
+    m_dividedSet.clear();
+    m_mDFANodeArr.clear();
+    m_mDFATrans.clear();
+    m_mDFAAccept.clear();
+    m_mDFAG.startState=-1;
+    m_mDFAG.endStateSet.clear();
+    m_phaseStats.partitionSplits=0;
+    m_phaseStats.refineRounds=0;
+}
+
+/**
+ * @brief NDFA::checkProgress
+ * @param phase
+ * @param count
+ * @return 是否继续转换
+ * 由转换的主循环每隔一段调用：报告进度并检查中止标志
+ */
+bool NDFA::checkProgress(Phase phase, int count)
+{
+    if(m_progressHandler)
+        m_progressHandler(phase, count);
+    return !cancelRequested();
+}
+
+bool NDFA::cancelRequested() const
+{
+    return m_cancelFlag && m_cancelFlag->loadRelaxed();
+}
+
+/**
+ * @brief NDFA::NFA2DFASerial
+ * @return 是否完成
+ * 单线程子集构造，逐个展开DFA状态：新状态按发现顺序编号，
+ * 按状态号顺序展开即广度优先的队列顺序，无需另设队列
+ */
+bool NDFA::NFA2DFASerial()
+{
+    StateSet tmpSet=stateClosure(m_NFAG.startState);//求NFA初态节点的epsilon闭包得到DFA初态
+
+    //状态集→DFA状态号索引，已存在的状态集可直接查到其状态号
+    QHash<StateSet, int> DFAStateIdx;
+    DFAStateIdx.insert(tmpSet, newDFANode(tmpSet));//从初态开始
+    m_phaseStats.DFAIndexInserts++;
+
+    //字符类号→move+closure集合，逐状态复用，clear保留容量
+    QList<StateSet> chToSetArr(m_classNum, StateSet(0, &m_arena));
+    QList<int> touchedClasses;//当前状态有出边的字符类
+    for(int t_curState=0;t_curState<m_DFAStateNum;t_curState++)
+    {
+        if(t_curState%ProgressInterval==0 && !checkProgress(DFAPhase, m_DFAStateNum))
+            return false;
+
+        //一次遍历当前序号集合，按字符类归并出边目标的epsilon闭包（位图并集），
+        //得到的即各字符类对应的move+closure集合；操作符覆盖的每个字符类都要归并
+        touchedClasses.clear();
+        for(const auto &t_state: m_DFAStateArr[t_curState].NFANodeSet)
+        {
+            const NFANode &node=m_NFAStateArr[t_state];
+            if(node.toState<0)//无非epsilon边
+                continue;
+            const StateSet &closure=stateClosure(node.toState);
+            for(const auto &c: m_symbolClasses[node.symbol])
+            {
+                if(chToSetArr[c].isEmpty())
+                    touchedClasses.append(c);
+                chToSetArr[c].unite(closure);
+            }
+        }
+
+        //按字符类号顺序处理，保证DFA状态编号确定；没有出边的字符类即该边被丢弃
+        std::sort(touchedClasses.begin(),touchedClasses.end());
+        for(const auto &ch: touchedClasses)
+        {
+            StateSet chToSet=chToSetArr[ch];//节点的（出边为字符类ch）的集合
+            chToSetArr[ch].clear();
+
+            m_phaseStats.DFAIndexLookups++;
+            auto it=DFAStateIdx.constFind(chToSet);
+            if(it==DFAStateIdx.constEnd())
+            {
+                //若该DFA状态节点不存在
+                //新建DFA节点 chToSet--ch-->xxx
+                int newState=newDFANode(chToSet);
+                DFAStateIdx.insert(std::move(chToSet), newState);
+                m_phaseStats.DFAIndexInserts++;
+                //更新原节点的信息，新节点随后按状态号顺序展开
+                m_DFATrans[t_curState*m_classNum+ch]=newState;//当前DFA节点能通过ch去到的新DFA状态
+            }
+            else
+            {   //若该DFA状态节点存在，由索引直接得到其状态号
+                m_DFATrans[t_curState*m_classNum+ch]=it.value();
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief NDFA::NFA2DFAParallel
+ * 按层同步的并行子集构造：每层的前沿状态由工作线程各自求出各字符类的
+ * move+closure集合（只读NFA与闭包缓存），再由本线程按前沿顺序、字符类顺序
+ * 查询/登记状态集索引并编号。编号顺序与单线程的队列顺序完全一致，
+ * 故结果与NFA2DFA逐状态相同，与线程数无关。
+ * 工作线程每展开一个状态检查一次中止标志，中止时本层作废
+ */
+bool NDFA::NFA2DFAParallel()
+{
+    StateSet tmpSet=stateClosure(m_NFAG.startState);
+
+    precomputeClosures();//工作线程只读闭包缓存
+
+    QHash<StateSet, int> DFAStateIdx;
+    DFAStateIdx.insert(tmpSet, newDFANode(tmpSet));
+    m_phaseStats.DFAIndexInserts++;
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(m_determinizeThreads);
+
+    QList<int> frontier={0};//当前层的DFA状态号，按编号递增
+    QList<QList<int>> levelClasses;//前沿第i个状态有出边的字符类（递增）
+    QList<QList<StateSet>> levelTargets;//与levelClasses对应的目标状态集
+    while(!frontier.empty())
+    {
+        const int frontierSize=frontier.size();
+        levelClasses=QList<QList<int>>(frontierSize);
+        levelTargets=QList<QList<StateSet>>(frontierSize);
+
+        //前沿按线程交错划分，各线程只写自己负责的下标
+        const int workerNum=qMin(m_determinizeThreads, frontierSize);
+        const int *frontierData=frontier.constData();
+        QList<int> *classesData=levelClasses.data();
+        QList<StateSet> *targetsData=levelTargets.data();
+        for(int w=0;w<workerNum;w++)
+        {
+            pool.start([this, w, workerNum, frontierSize, frontierData, classesData, targetsData]{
+                QList<StateSet> chToSetArr(m_classNum);
+                for(int i=w;i<frontierSize && !cancelRequested();i+=workerNum)
+                    expandDFAState(m_DFAStateArr.at(frontierData[i]).NFANodeSet, chToSetArr,
+                                   classesData[i], targetsData[i]);
+            });
+        }
+        pool.waitForDone();
+        if(!checkProgress(DFAPhase, m_DFAStateNum))
+            return false;
+
+        //按前沿顺序合并，新状态依次编号并组成下一层
+        QList<int> nextFrontier;
+        for(int i=0;i<frontierSize;i++)
+        {
+            const int t_curState=frontier[i];
+            for(int k=0;k<levelClasses[i].size();k++)
+            {
+                const StateSet &chToSet=levelTargets[i][k];
+                m_phaseStats.DFAIndexLookups++;
+                auto it=DFAStateIdx.constFind(chToSet);
+                int to;
+                if(it==DFAStateIdx.constEnd())
+                {
+                    to=newDFANode(chToSet);
+                    DFAStateIdx.insert(chToSet, to);
+                    m_phaseStats.DFAIndexInserts++;
+                    nextFrontier.append(to);
+                }
+                else
+                    to=it.value();
+                m_DFATrans[t_curState*m_classNum+levelClasses[i][k]]=to;
+            }
+        }
+        frontier=nextFrontier;
+    }
+    return true;
+}
+
+/**
+ * @brief NDFA::expandDFAState
+ * @param NFANodeSet
+ * @param chToSetArr 字符类号→集合的工作区，调用前后均为空
+ * @param classes 有出边的字符类，递增
+ * @param targets 各字符类的move+closure集合
+ * 与NFA2DFA中单个状态的展开相同，但只读成员，可在工作线程中调用；
+ * 要求所需的闭包已在m_NFAClosureArr中求出
+ */
+void NDFA::expandDFAState(const StateSet &NFANodeSet, QList<StateSet> &chToSetArr,
+                          QList<int> &classes, QList<StateSet> &targets) const
+{
+    for(const auto &t_state: NFANodeSet)
+    {
+        const NFANode &node=m_NFAStateArr.at(t_state);
+        if(node.toState<0)
+            continue;
+        const StateSet &closure=m_NFAClosureArr.at(node.toState);
+        for(const auto &c: m_symbolClasses.at(node.symbol))
+        {
+            if(chToSetArr[c].isEmpty())
+                classes.append(c);
+            chToSetArr[c].unite(closure);
+        }
+    }
+
+    std::sort(classes.begin(),classes.end());
+    for(const auto &c: classes)
+    {
+        targets.append(chToSetArr[c]);
+        chToSetArr[c].clear();
+    }
+}
+
+/**
+ * @brief NDFA::NFA2DFAFollowpos
+ * @return 是否完成
+ * 与NFA2DFASerial相同的逐状态展开，DFA状态为位置集合：位置p经其操作符覆盖的字符类
+ * 到达followpos(p)，各字符类的目标即这些集合之并，无需求epsilon闭包
+ */
+bool NDFA::NFA2DFAFollowpos()
+{
+    QHash<StateSet, int> DFAStateIdx;
+    DFAStateIdx.insert(m_startPos, newDFANode(m_startPos));
+    m_phaseStats.DFAIndexInserts++;
+
+    QList<StateSet> chToSetArr(m_classNum, StateSet(0, &m_arena));
+    QList<int> touchedClasses;
+    for(int t_curState=0;t_curState<m_DFAStateNum;t_curState++)
+    {
+        if(t_curState%ProgressInterval==0 && !checkProgress(DFAPhase, m_DFAStateNum))
+            return false;
+
+        touchedClasses.clear();
+        for(const auto &pos: m_DFAStateArr[t_curState].NFANodeSet)
+        {
+            const int symbol=m_posSymbol[pos];
+            if(symbol<0)//结束标记
+                continue;
+            const StateSet &follow=m_followpos[pos];
+            for(const auto &c: m_symbolClasses[symbol])
+            {
+                if(chToSetArr[c].isEmpty())
+                    touchedClasses.append(c);
+                chToSetArr[c].unite(follow);
+            }
+        }
+
+        std::sort(touchedClasses.begin(),touchedClasses.end());
+        for(const auto &ch: touchedClasses)
+        {
+            StateSet chToSet=chToSetArr[ch];
+            chToSetArr[ch].clear();
+
+            m_phaseStats.DFAIndexLookups++;
+            auto it=DFAStateIdx.constFind(chToSet);
+            if(it==DFAStateIdx.constEnd())
+            {
+                int newState=newDFANode(chToSet);
+                DFAStateIdx.insert(std::move(chToSet), newState);
+                m_phaseStats.DFAIndexInserts++;
+                m_DFATrans[t_curState*m_classNum+ch]=newState;
+            }
+            else
+                m_DFATrans[t_curState*m_classNum+ch]=it.value();
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief NDFA::acceptRuleOf
+ * @param set NFA状态集，followpos构造时为位置集
+ * @return 所含终态（结束标记）中优先级最高的规则号，-1为非终态
+ */
+int NDFA::acceptRuleOf(const StateSet &set) const
+{
+    if(m_constructEngine==FollowposConstruct)
+    {
+        for(int rule=0;rule<m_ruleEndPos.size();rule++)
+            if(set.contains(m_ruleEndPos[rule]))
+                return rule;
+        return -1;
+    }
+    for(const auto &state: m_NFAAcceptStates)
+        if(set.contains(state))
+            return m_NFAStateArr[state].acceptRule;
+    return -1;
+}
+
+/**
+ * @brief NDFA::newDFANode
+ * @param NFANodeSet
+ * @return 新DFA节点状态号
+ * 在DFA状态数组末尾追加一个包含NFANodeSet的节点，并在转换表中追加一行，
+ * 若含NFA终态则记为DFA终态，并记录其接受的规则号
+ */
+int NDFA::newDFANode(const StateSet &NFANodeSet)
+{
+    DFANode node;
+    node.init();
+    node.stateNum=m_DFAStateNum;
+    node.NFANodeSet=NFANodeSet;
+    m_DFAStateArr.append(std::move(node));
+    m_DFATrans.resize(m_DFATrans.size()+m_classNum, -1);//新增一行，暂无出边
+
+    //所含NFA终态中优先级最高的规则即该DFA状态接受的规则
+    int accept=acceptRuleOf(NFANodeSet);
+    m_DFAAccept.append(accept);
+    if(accept>=0)
+        m_DFAEndStateSet.insert(m_DFAStateNum);
+    return m_DFAStateNum++;
+}
+
+/**
+ * @brief NDFA::DFA2mDFA
+ * @return 是否完成
+ * DFA的最小化：先按所选算法求出DFA状态的等价划分，再由划分生成最小化DFA
+ */
+bool NDFA::DFA2mDFA()
+{
+    QElapsedTimer timer;
+    timer.start();
+    clearMDFA();
+    const qint64 arenaAllocs=m_arena.stats().allocations;
+    bool completed=m_minimizeEngine==IterativeMinimize ? divideIterative() : divideHopcroft();
+    if(!completed)
+    {
+        clearMDFA();//划分未完成，不生成最小化DFA
+        recordArenaStats(mDFAPhase, arenaAllocs);
+        m_phaseStats.phaseNs[mDFAPhase]=timer.nsecsElapsed();
+        return false;
+    }
+
+    //DFA状态号→所属划分号，建立mDFA边时直接查表
+    ArenaVector<int> stateBlock(m_DFAStateNum, -1, &m_arena);
+    for(int i=0;i<m_mDFAStateNum;i++)
+        for(const auto &state: m_dividedSet[i])
+            stateBlock[state]=i;
+
+    //遍历所有mDFA状态
+    m_mDFANodeArr.resize(m_mDFAStateNum);
+    m_mDFATrans=QList<int>(m_mDFAStateNum*m_classNum, -1);
+    m_mDFAAccept=QList<int>(m_mDFAStateNum, -1);
+    for(int i=0;i<m_mDFAStateNum;i++)
+    {
+        m_mDFANodeArr[i].DFAStatesSet=m_dividedSet[i];//保存每一个暂存划分到mDFA中
+        for(const auto &state: m_dividedSet[i])//遍历每一个mDFA划分子集
+        {
+            //若为初态
+            if(state==0)
+            {
+                m_mDFAG.startState=i;
+            }
+            //若为终态
+            if(m_DFAEndStateSet.contains(state))
+            {
+                m_mDFAG.endStateSet.insert(i);//加入终态集
+                m_mDFAAccept[i]=m_DFAAccept[state];//同一划分内接受的规则相同
+            }
+
+            //遍历当前状态的所有出边
+            const int *row=m_DFATrans.constData()+state*m_classNum;
+            int *mRow=m_mDFATrans.data()+i*m_classNum;
+            for(int c=0;c<m_classNum;c++)
+            {
+                //若该边不存在，插入边（完善mDFA边信息）
+                if(row[c]>=0 && mRow[c]<0)
+                    mRow[c]=stateBlock[row[c]];
+            }
+        }
+    }
+
+    m_phaseStats.mDFAStateNum=m_mDFAStateNum;
+    m_phaseStats.mDFAEdgeNum=0;
+    for(const auto &to: m_mDFATrans)
+        if(to>=0)
+            m_phaseStats.mDFAEdgeNum++;
+    m_phaseStats.mDFABytes=qint64(m_mDFATrans.size())*sizeof(int)
+            +qint64(m_DFAStateNum)*2*sizeof(int);//划分中的DFA状态号，QSet节点按约两个int计
+    recordArenaStats(mDFAPhase, arenaAllocs);
+    m_phaseStats.phaseNs[mDFAPhase]=timer.nsecsElapsed();
+    return true;
+}
+
+
+/**
+ * @brief NDFA::divideIterative
+ * @return 是否完成
+ * 原有的划分算法：反复遍历所有划分及所有字符类，直到不再产生新的划分
+ */
+bool NDFA::divideIterative()
+{
+    //初始划分：接受同一规则的终态各为一组（按规则号排列），非终态为最后一组；
+    //单条正则表达式时即[0]终态集合，[1]非终态集合
+    const int ruleNum=m_ruleNames.size();
+    QList<QSet<int>> initSet(ruleNum+1);
+    for(int i=0;i<m_DFAStateNum;i++)//遍历DFA状态集合
+        initSet[m_DFAAccept[i]>=0 ? m_DFAAccept[i] : ruleNum].insert(m_DFAStateArr[i].stateNum);
+    m_dividedSet.clear();
+    for(const auto &set: initSet)
+        if(!set.isEmpty())
+            m_dividedSet.append(set);
+    m_mDFAStateNum=m_dividedSet.size();
+
+    bool divFlag=true;//表示是否有新状态划分出来，有则真，无则假
+    while(divFlag)
+    {
+        //遍历mDFA状态
+        divFlag=false;
+        m_phaseStats.refineRounds++;
+        for(int i=0;i<m_mDFAStateNum;i++)
+        {
+            if(!checkProgress(mDFAPhase, m_mDFAStateNum))
+                return false;
+            //遍历字符类
+            for(int opChar=0;opChar<m_classNum;opChar++)
             {
                 int t_divCount = 0;//暂存划分状态计数，从0开始
-                stateSet t_stateSet[ARR_TEMP_SIZE];//分出的状态
+                QList<stateSet> t_stateSet;//分出的状态，按需增长
 
                 for(const auto &t_state: m_dividedSet[i])//遍历当前划分状态集中的所有节点
                 {
                     //若当前DFA节点能通过opChar边到达另外一个节点
-                    if(m_DFAStateArr[t_state].DFAEdgeMap.contains(opChar))
+                    int toState=m_DFATrans[t_state*m_classNum+opChar];
+                    if(toState>=0)
                     {
                         //通过opChar到达的节点所属状态划分集合 号
-                        int toIdx=getStateId(m_dividedSet, m_DFAStateArr[t_state].DFAEdgeMap[opChar]);
+                        int toIdx=getStateId(m_dividedSet, toState);
                         bool haveSameDiv=false;
                         for(int j=0;j<t_divCount;j++)
                         {
@@ -761,8 +1980,7 @@ void NDFA::DFA2mDFA()
                         if(!haveSameDiv)
                         {
                             //若状态不在相同的划分，即出现了新的划分
-                            t_stateSet[t_divCount].stateSetId=toIdx;
-                            t_stateSet[t_divCount].DFAStateSet.insert(t_state);
+                            t_stateSet.append(stateSet{{t_state},toIdx});
                             t_divCount++;//暂存划分计数增加
                         }
                     }
@@ -782,8 +2000,7 @@ void NDFA::DFA2mDFA()
                         if(!haveSame)
                         {
                             //若状态不在相同的划分，即出现了新的划分
-                            t_stateSet[t_divCount].stateSetId=-1;//不可达的标记
-                            t_stateSet[t_divCount].DFAStateSet.insert(t_state);
+                            t_stateSet.append(stateSet{{t_state},-1});//-1为不可达的标记
                             t_divCount++;//分出来的新状态增加
                         }
                     }
@@ -792,55 +2009,592 @@ void NDFA::DFA2mDFA()
                 if(t_divCount>1)//大于1即产生了新的划分
                 {
                     divFlag=true;
+                    m_phaseStats.partitionSplits+=t_divCount-1;
                     for(int j=1;j<t_divCount;j++)//遍历暂存划分集合
                     {
                         for(const auto &state: t_stateSet[j].DFAStateSet)
                         {
                             //将被分出去的DFA节点序号从原来状态中去除
                             m_dividedSet[i].remove(state);
-                            //加入新状态
-                            m_dividedSet[m_mDFAStateNum].insert(state);
                         }
+                        //加入新状态
+                        m_dividedSet.append(t_stateSet[j].DFAStateSet);
                         m_mDFAStateNum++;
                     }
                 }
             }
         }
     }
+    return true;
+}
+
+/**
+ * @brief NDFA::divideHopcroft
+ * @return 是否完成
+ * Hopcroft划分求精算法，时间复杂度O(n·|Σ|·log n)
+ * 缺失的边视为指向一个单独的死状态（序号m_DFAStateNum），死状态自成初始划分，
+ * 因此“无边”与“有边”的状态仍会被区分，结果与原算法一致；
+ * 以逆转移表求出能通过某字符类到达分割集的状态，分割后只把较小的一半放入工作表
+ */
+bool NDFA::divideHopcroft()
+{
+    const int symNum=m_classNum;
+    const int n=m_DFAStateNum+1;//含死状态
+    const int dead=m_DFAStateNum;
+
+    //转移表 trans[s*symNum+a]，a为字符类号：DFA转换表中的-1改为指向死状态，死状态的所有边指向自身
+    ArenaVector<int> trans(n*symNum, dead, &m_arena);
+    for(int i=0;i<m_DFAStateNum*symNum;i++)
+        if(m_DFATrans[i]>=0)
+            trans[i]=m_DFATrans[i];
+
+    //逆转移表（按字符类分段的CSR）：invSrc[invOff[a*(n+1)+t] .. invOff[a*(n+1)+t+1]) 为经a到达t的状态
+    ArenaVector<int> invOff(symNum*(n+1)+1, 0, &m_arena);
+    ArenaVector<int> invSrc(n*symNum, 0, &m_arena);
+    for(int s=0;s<n;s++)
+        for(int a=0;a<symNum;a++)
+            invOff[a*(n+1)+trans[s*symNum+a]+1]++;
+    for(size_t i=1;i<invOff.size();i++)
+        invOff[i]+=invOff[i-1];
+    {
+        ArenaVector<int> fill=invOff;
+        for(int s=0;s<n;s++)
+            for(int a=0;a<symNum;a++)
+            {
+                int t=trans[s*symNum+a];
+                invSrc[fill[a*(n+1)+t]++]=s;
+            }
+    }
+
+    //可细分划分：elems中同一划分的状态连续存放于[first,end)，[first,mid)为已标记部分
+    ArenaVector<int> elems(n, 0, &m_arena), loc(n, 0, &m_arena), blk(n, 0, &m_arena);
+    ArenaVector<int> first(&m_arena), end(&m_arena), mid(&m_arena);
+    {
+        //初始划分：按接受的规则号分组的终态、非终态、死状态，按键计数排序
+        const int ruleNum=m_ruleNames.size();
+        ArenaVector<int> initKey(n, 0, &m_arena);
+        for(int s=0;s<m_DFAStateNum;s++)
+            initKey[s]=m_DFAAccept[s]>=0 ? m_DFAAccept[s] : ruleNum;
+        initKey[dead]=ruleNum+1;
+
+        ArenaVector<int> keyCount(ruleNum+2, 0, &m_arena), keyStart(ruleNum+2, 0, &m_arena), keyBlk(ruleNum+2, -1, &m_arena);
+        for(int s=0;s<n;s++)
+            keyCount[initKey[s]]++;
+        int pos=0;
+        for(int key=0;key<ruleNum+2;key++)
+        {
+            keyStart[key]=pos;
+            if(keyCount[key])
+            {
+                keyBlk[key]=int(first.size());
+                first.push_back(pos);
+                end.push_back(pos+keyCount[key]);
+                mid.push_back(pos);
+            }
+            pos+=keyCount[key];
+        }
+        for(int s=0;s<n;s++)
+        {
+            int key=initKey[s];
+            elems[keyStart[key]]=s;
+            loc[s]=keyStart[key]++;
+            blk[s]=keyBlk[key];
+        }
+    }
+
+    //工作表：除最大的初始划分外全部加入
+    const int initBlocks=int(first.size());
+    ArenaVector<int> workList(&m_arena);
+    ArenaVector<bool> inWork(initBlocks, false, &m_arena);
+    int largest=0;
+    for(int b=1;b<initBlocks;b++)
+        if(end[b]-first[b]>end[largest]-first[largest])
+            largest=b;
+    for(int b=0;b<initBlocks;b++)
+        if(b!=largest)
+        {
+            workList.push_back(b);
+            inWork[b]=true;
+        }
+
+    ArenaVector<int> splitter(&m_arena), touched(&m_arena);
+    while(!workList.empty())
+    {
+        if(m_phaseStats.refineRounds%ProgressInterval==0 && !checkProgress(mDFAPhase, int(first.size())))
+            return false;
+        int A=workList.back();
+        workList.pop_back();
+        inWork[A]=false;
+        m_phaseStats.refineRounds++;
+        splitter.assign(elems.begin()+first[A], elems.begin()+end[A]);//分割集在本轮中保持不变，复用容量
+
+        for(int a=0;a<symNum;a++)
+        {
+            //标记所有经a可到达分割集的状态，移动到各自划分的已标记部分
+            touched.clear();
+            for(const auto &t: splitter)
+            {
+                for(int i=invOff[a*(n+1)+t];i<invOff[a*(n+1)+t+1];i++)
+                {
+                    int p=invSrc[i];
+                    int b=blk[p];
+                    if(loc[p]<mid[b])//已标记
+                        continue;
+                    if(mid[b]==first[b])
+                        touched.push_back(b);
+                    int q=elems[mid[b]];//与未标记部分的第一个交换
+                    elems[loc[p]]=q;
+                    loc[q]=loc[p];
+                    elems[mid[b]]=p;
+                    loc[p]=mid[b];
+                    mid[b]++;
+                }
+            }
+
+            //被部分标记的划分一分为二
+            for(const auto &b: touched)
+            {
+                if(mid[b]==end[b])//全部被标记，无需分割
+                {
+                    mid[b]=first[b];
+                    continue;
+                }
+                m_phaseStats.partitionSplits++;
+                int nb=int(first.size());//已标记部分成为新划分
+                first.push_back(first[b]);
+                end.push_back(mid[b]);
+                mid.push_back(first[b]);
+                inWork.push_back(false);
+                first[b]=mid[b];
+                for(int i=first[nb];i<end[nb];i++)
+                    blk[elems[i]]=nb;
+
+                if(inWork[b] || end[nb]-first[nb]<=end[b]-first[b])
+                {
+                    workList.push_back(nb);
+                    inWork[nb]=true;
+                }
+                else
+                {
+                    workList.push_back(b);
+                    inWork[b]=true;
+                }
+            }
+        }
+    }
+
+    //按DFA状态号顺序为划分重新编号（含DFA初态的划分为0号），丢弃死状态所在的划分
+    ArenaVector<int> blockId(first.size(), -1, &m_arena);
+    m_dividedSet.clear();
+    m_mDFAStateNum=0;
+    for(int s=0;s<m_DFAStateNum;s++)
+    {
+        int b=blk[s];
+        if(blockId[b]<0)
+        {
+            blockId[b]=m_mDFAStateNum++;
+            m_dividedSet.append(QSet<int>());
+        }
+        m_dividedSet[blockId[b]].insert(s);
+    }
+    return true;
+}
+
+/**
+ * @brief NDFA::genSwitchLoop
+ * @param codeStr
+ * switch后端：每个状态一个case，状态内按字符类分支，随后对终态向前看一个字符判断是否结束
+ */
+void NDFA::genSwitchLoop(QString &codeStr)
+{
+    codeStr+="\t\tswitch (state) {\n";
 
-    //遍历所有mDFA状态
     for(int i=0;i<m_mDFAStateNum;i++)
     {
-        m_mDFANodeArr[i].DFAStatesSet=m_dividedSet[i];//保存每一个暂存划分到mDFA中
-        for(const auto &state: m_dividedSet[i])//遍历每一个mDFA划分子集
+        QList<int> tmpList;//该状态的所有边（字符类号）
+        for(int c=0;c<m_classNum;c++)
+            if(m_mDFATrans[i*m_classNum+c]>=0)
+                tmpList.append(c);
+        if(tmpList.size()){
+            codeStr+="\t\tcase "+QString::number(i)+": {\n";
+            codeStr+="\t\t\tswitch (ec[(unsigned char)tmp]) {\n";
+            if(genLexCase(tmpList,codeStr,i,1))
+                codeStr+="\t\t\tdefault:state = "+QString::number(m_mDFATrans[i*m_classNum+m_otherClass])+"; isAnnotation = true; break;\n";
+            codeStr+="\t\t\t}\n";
+            codeStr+="\t\t\tbreak;\n";
+            codeStr+="\t\t}\n";
+        }
+    }
+    codeStr+="\t\t}\n";
+
+    QList<int> stateList=m_mDFAG.endStateSet.values();//所有终态
+
+    codeStr+="\t\tif (";
+    for(int i=0;i<stateList.size();i++)
+    {
+        //要提前读一个字符判断是不是真的到终态，因为到了终态不一定是真正的终态
+        int num=stateList[i];
+        if(i)codeStr+="\t\telse if (";
+        codeStr+="state =="+QString::number(num)+") {\n";
+        codeStr+="\t\t\tswitch (p < end ? ec[(unsigned char)*p] : -1) {\n";//输入结束时走default
+        QList<int> tmpList;//该状态的所有边（字符类号）
+        for(int c=0;c<m_classNum;c++)
+            if(m_mDFATrans[num*m_classNum+c]>=0)
+                tmpList.append(c);
+        genLexCase(tmpList,codeStr,num,0);
+        codeStr+="\t\t\tdefault: {\n";
+        codeStr+="\t\t\t\tflag=true;\n";
+        bool hasLetter=false;
+        for(const auto &c: symbolClasses("letter"))
+            if(tmpList.contains(c))hasLetter=true;
+        if(hasLetter)
+            codeStr+="\t\t\t\tisIdentifier = true;\n";
+        codeStr+="\t\t\t}\n"
+                 "\t\t\t}\n"
+                 "\t\t}\n";
+    }
+}
+
+/**
+ * @brief NDFA::genLexTables
+ * @param codeStr
+ * 表驱动后端：以静态数组输出最小化DFA。
+ * trans为转换表，“~”边在生成时已展开到该状态所有没有显式边的字符类上，-1表示停留在原状态；
+ * act为各条边的动作位：1 向前看时可继续，2 置isIdentifier，4 置isDigit，8 置isAnnotation；
+ * accept为终态标记：1 终态，2 终态且结束时置isIdentifier
+ */
+void NDFA::genLexTables(QString &codeStr)
+{
+    const QList<int> letterClasses=symbolClasses("letter");
+    const QList<int> digitClasses=symbolClasses("digit");
+    const char *transType=m_mDFAStateNum<=32767 ? "short" : "int";
+
+    QString transStr, actStr, acceptStr;
+    for(int i=0;i<m_mDFAStateNum;i++)
+    {
+        const int *row=m_mDFATrans.constData()+i*m_classNum;
+        int otherTo=row[m_otherClass];//“~”边，缺省时为-1
+        transStr+="\t{";
+        actStr+="\t{";
+        bool hasLetter=false;
+        for(int c=0;c<m_classNum;c++)
         {
-            //若为初态
-            if(state==0)
+            int to=row[c];
+            int act=0;
+            if(to>=0 && c!=m_otherClass)
             {
-                m_mDFAG.startState=i;
+                act|=1;
+                if(letterClasses.contains(c)){act|=2;hasLetter=true;}
+                if(digitClasses.contains(c))act|=4;
             }
-            //若为终态
-            if(m_DFAEndStateSet.contains(state))
+            else if(otherTo>=0)
             {
-                m_mDFAG.endStateSet.insert(i);//加入终态集
+                to=otherTo;
+                act|=8;
+            }
+            transStr+=QString::number(to)+(c+1<m_classNum ? "," : "");
+            actStr+=QString::number(act)+(c+1<m_classNum ? "," : "");
+        }
+        transStr+=QString("}")+(i+1<m_mDFAStateNum ? "," : "")+"\n";
+        actStr+=QString("}")+(i+1<m_mDFAStateNum ? "," : "")+"\n";
+
+        int accept=m_mDFAG.endStateSet.contains(i) ? (hasLetter ? 2 : 1) : 0;
+        acceptStr+=QString::number(accept)+(i+1<m_mDFAStateNum ? "," : "");
+    }
+
+    QString dims="["+QString::number(m_mDFAStateNum)+"]["+QString::number(m_classNum)+"]";
+    codeStr+=QString("static const ")+transType+" trans"+dims+" = {\n"+transStr+"};\n";
+    codeStr+="static const unsigned char act"+dims+" = {\n"+actStr+"};\n";
+    codeStr+="static const unsigned char accept["+QString::number(m_mDFAStateNum)+"] = { "+acceptStr+" };\n";
+}
+
+/**
+ * @brief NDFA::genTableLoop
+ * @param codeStr
+ * 表驱动后端的分析循环：查表转换，终态处向前看一个字符，行为与switch后端一致
+ */
+void NDFA::genTableLoop(QString &codeStr)
+{
+    codeStr+="\t\tint cls = ec[(unsigned char)tmp];\n"
+             "\t\tif (trans[state][cls] >= 0) {\n"
+             "\t\t\tunsigned char a = act[state][cls];\n"
+             "\t\t\tif (a & 2) isIdentifier = true;\n"
+             "\t\t\tif (a & 4) isDigit = true;\n"
+             "\t\t\tif (a & 8) isAnnotation = true;\n"
+             "\t\t\tstate = trans[state][cls];\n"
+             "\t\t}\n";
+    //要提前读一个字符判断是不是真的到终态，因为到了终态不一定是真正的终态
+    codeStr+="\t\tif (accept[state]) {\n"
+             "\t\t\tif (p == end || !(act[state][ec[(unsigned char)*p]] & 1)) {\n"
+             "\t\t\t\tflag = true;\n"
+             "\t\t\t\tif (accept[state] == 2) isIdentifier = true;\n"
+             "\t\t\t}\n"
+             "\t\t}\n";
+}
+
+/**
+ * @brief cStringLiteral
+ * @param word
+ * @return 生成代码中的C字符串字面量，引号、反斜杠及不可打印字符转义
+ */
+static QString cStringLiteral(const QByteArray &word)
+{
+    QString str="\"";
+    for(const auto &ch: word)
+    {
+        if(ch=='"' || ch=='\\')str+='\\';
+        if(uchar(ch)>=32 && uchar(ch)<127)str+=QChar(ch);
+        else str+=QString("\\%1").arg(uchar(ch),3,8,QChar('0'));
+    }
+    return str+"\"";
+}
+
+/**
+ * @brief keywordKey
+ * @param word
+ * @param mode
+ * @return 关键字的32位键
+ * 与生成代码中isKeyword的计算完全一致：mode 0只取长度、首字符与尾字符，
+ * mode 1对全部字符做FNV-1a
+ */
+static quint32 keywordKey(const QByteArray &word, int mode)
+{
+    if(mode==0)
+        return quint32(word.size())|quint32(uchar(word.front()))<<8|quint32(uchar(word.back()))<<16;
+    quint32 x=2166136261u;
+    for(const auto &ch: word)
+        x=(x^uchar(ch))*16777619u;
+    return x;
+}
+
+/**
+ * @brief NDFA::genKeywordHash
+ * @param codeStr
+ * 为关键字表生成无冲突的完美哈希，生成的isKeyword只需一次哈希与一次比较，不分配内存。
+ * 关键字较少时先尝试只用长度与首尾字符：搜索乘数mul使 (key*mul)>>(32-bits) 互不冲突；
+ * 否则对全部字符求FNV-1a，再按低位分桶、逐桶搜索偏移量（hash and displace），
+ * 槽位为 ((key^disp[桶])*mul)>>(32-bits)，大桶优先放置
+ */
+void NDFA::genKeywordHash(QString &codeStr)
+{
+    QList<QByteArray> keywordList;
+    for(const auto &keyword: m_reg_keyword_str.split('|'))
+    {
+        QByteArray word=keyword.toUtf8();
+        if(!word.isEmpty() && !keywordList.contains(word))
+            keywordList.append(word);
+    }
+    const int n=keywordList.size();
+    const quint32 mul=2654435761u;//Knuth乘法哈希常数
+
+    int bits=1;//槽位数为不小于关键字数的2的幂
+    while((1<<bits)<n)
+        bits++;
+
+    QList<int> slot;
+    QList<quint32> dispList;//各桶偏移量，为空表示只用首尾字符哈希
+    quint32 mul0=0;
+    bool found=false;
+
+    //首尾字符哈希：键只有长度与首尾字符，需搜索乘数
+    quint32 seed=0x9e3779b1u;
+    for(int b=bits;!found && b<=bits+2 && n>0;b++)
+        for(int tries=0;!found && tries<2000;tries++)
+        {
+            seed=seed*1664525u+1013904223u;//线性同余序列，保证生成结果确定
+            slot=QList<int>(1<<b, -1);
+            found=true;
+            for(int i=0;i<n && found;i++)
+            {
+                quint32 h=quint32(keywordKey(keywordList[i], 0)*(seed|1u))>>(32-b);
+                if(slot[h]>=0)found=false;
+                else slot[h]=i;
+            }
+            if(found)
+            {
+                bits=b;
+                mul0=seed|1u;
             }
+        }
 
-            //遍历所有操作符
-            for(const auto &opChar: m_opCharSet)
+    //全字符哈希+逐桶偏移
+    int bucketBits=0;
+    for(int b=bits;!found && b<=bits+2;b++)
+    {
+        bucketBits=0;
+        while((2<<bucketBits)<n)//平均每桶约两个关键字
+            bucketBits++;
+        const quint32 bucketMask=(1u<<bucketBits)-1;
+
+        QList<QList<int>> buckets(1<<bucketBits);
+        for(int i=0;i<n;i++)
+            buckets[keywordKey(keywordList[i], 1)&bucketMask].append(i);
+        QList<int> order;
+        for(int k=0;k<buckets.size();k++)
+            order.append(k);
+        std::stable_sort(order.begin(),order.end(),[&](int x,int y){
+            return buckets[x].size()>buckets[y].size();
+        });
+
+        slot=QList<int>(1<<b, -1);
+        dispList=QList<quint32>(1<<bucketBits, 0);
+        found=true;
+        QList<int> taken;
+        for(const auto &k: order)
+        {
+            if(buckets[k].isEmpty())
+                break;
+            bool placed=false;
+            for(quint32 d=0;!placed && d<(1u<<20);d++)
             {
-                //若当前状态可通过opChar边到达别的状态
-                if(m_DFAStateArr[state].DFAEdgeMap.contains(opChar))
+                taken.clear();
+                placed=true;
+                for(const auto &i: buckets[k])
                 {
-                    int id=getStateId(m_dividedSet,m_DFAStateArr[state].DFAEdgeMap[opChar]);
-                    //若该边不存在，插入边（完善mDFA边信息）
-                    if(!m_mDFANodeArr[i].mDFAEdgesMap.contains(opChar))
+                    quint32 h=quint32((keywordKey(keywordList[i], 1)^d)*mul)>>(32-b);
+                    if(slot[h]>=0 || taken.contains(h))
                     {
-                        m_mDFANodeArr[i].mDFAEdgesMap[opChar]=id;
+                        placed=false;
+                        break;
                     }
+                    taken.append(h);
+                }
+                if(placed)
+                {
+                    dispList[k]=d;
+                    for(int t=0;t<taken.size();t++)
+                        slot[taken[t]]=buckets[k][t];
                 }
             }
+            if(!placed)
+            {
+                found=false;
+                break;
+            }
+        }
+        if(found)
+            bits=b;
+    }
+
+    if(n==0 || !found)
+    {
+        //无关键字；或存在全字符哈希完全相同的关键字（几乎不会发生），退化为逐个比较
+        QString tableStr, lenStr;
+        for(int i=0;i<n;i++)
+        {
+            tableStr+=cStringLiteral(keywordList[i])+",";
+            lenStr+=QString::number(keywordList[i].size())+",";
+        }
+        codeStr+="static const char* const kwTable[] = { "+tableStr+"0 };\n";
+        codeStr+="static const unsigned int kwLen[] = { "+lenStr+"0 };\n";
+        codeStr+="static bool isKeyword(const char* s, size_t len) {\n"
+                 "\tfor (int i = 0; kwTable[i]; i++)\n"
+                 "\t\tif (kwLen[i] == len && memcmp(kwTable[i], s, len) == 0) return true;\n"
+                 "\treturn false;\n"
+                 "}\n";
+        return;
+    }
+
+    QString tableStr, lenStr;
+    for(int i=0;i<slot.size();i++)
+    {
+        tableStr+=(slot[i]<0 ? QString("0") : cStringLiteral(keywordList[slot[i]]))+(i+1<slot.size() ? "," : "");
+        lenStr+=QString::number(slot[i]<0 ? 0 : keywordList[slot[i]].size())+(i+1<slot.size() ? "," : "");
+    }
+    QString sizeStr=QString::number(slot.size());
+    codeStr+="static const char* const kwTable["+sizeStr+"] = { "+tableStr+" };\n";
+    codeStr+="static const unsigned int kwLen["+sizeStr+"] = { "+lenStr+" };\n";
+    if(mul0)
+    {
+        codeStr+="static bool isKeyword(const char* s, size_t len) {\n"
+                 "\tuint32_t x = (uint32_t)len | (uint32_t)(unsigned char)s[0] << 8 | (uint32_t)(unsigned char)s[len - 1] << 16;\n"
+                 "\tuint32_t h = (uint32_t)(x * "+QString::number(mul0)+"u) >> "+QString::number(32-bits)+";\n";
+    }
+    else
+    {
+        QString dispStr;
+        for(int k=0;k<dispList.size();k++)
+            dispStr+=QString::number(dispList[k])+(k+1<dispList.size() ? "," : "");
+        codeStr+="static const uint32_t kwDisp["+QString::number(dispList.size())+"] = { "+dispStr+" };\n";
+        codeStr+="static bool isKeyword(const char* s, size_t len) {\n"
+                 "\tuint32_t x = 2166136261u;\n"
+                 "\tfor (size_t i = 0; i < len; i++) x = (x ^ (unsigned char)s[i]) * 16777619u;\n"
+                 "\tuint32_t h = (uint32_t)((x ^ kwDisp[x & "+QString::number((1u<<bucketBits)-1)+"u]) * "+QString::number(mul)+"u) >> "+QString::number(32-bits)+";\n";
+    }
+    codeStr+="\treturn kwLen[h] == len && memcmp(kwTable[h], s, len) == 0;\n"
+             "}\n";
+}
+
+/**
+ * @brief NDFA::genRuleTables
+ * @param codeStr
+ * 多规则模式的静态表：accept为各状态接受的规则号（-1为非终态），ruleName为输出前缀，
+ * ruleSkip标记不输出的规则；表驱动后端另输出trans，“~”边已展开到没有显式边的字符类上
+ */
+void NDFA::genRuleTables(QString &codeStr)
+{
+    QString nameStr, skipStr, acceptStr;
+    for(int r=0;r<m_ruleNames.size();r++)
+    {
+        nameStr+=cStringLiteral((m_ruleNames[r]+":").toUtf8())+(r+1<m_ruleNames.size() ? "," : "");
+        skipStr+=QString(m_ruleSkip[r] ? "1" : "0")+(r+1<m_ruleNames.size() ? "," : "");
+    }
+    for(int i=0;i<m_mDFAStateNum;i++)
+        acceptStr+=QString::number(m_mDFAAccept[i])+(i+1<m_mDFAStateNum ? "," : "");
+    codeStr+="static const char* const ruleName["+QString::number(m_ruleNames.size())+"] = { "+nameStr+" };\n";
+    codeStr+="static const unsigned char ruleSkip["+QString::number(m_ruleNames.size())+"] = { "+skipStr+" };\n";
+    codeStr+=QString("static const ")+(m_ruleNames.size()<=32767 ? "short" : "int")
+            +" accept["+QString::number(m_mDFAStateNum)+"] = { "+acceptStr+" };\n";
+
+    if(m_lexerBackend!=TableBackend)
+        return;
+    QString transStr;
+    for(int i=0;i<m_mDFAStateNum;i++)
+    {
+        const int *row=m_mDFATrans.constData()+i*m_classNum;
+        transStr+="\t{";
+        for(int c=0;c<m_classNum;c++)
+        {
+            int to=row[c]>=0 ? row[c] : row[m_otherClass];
+            transStr+=QString::number(to)+(c+1<m_classNum ? "," : "");
+        }
+        transStr+=QString("}")+(i+1<m_mDFAStateNum ? "," : "")+"\n";
+    }
+    codeStr+=QString("static const ")+(m_mDFAStateNum<=32767 ? "short" : "int")
+            +" trans["+QString::number(m_mDFAStateNum)+"]["+QString::number(m_classNum)+"] = {\n"+transStr+"};\n";
+}
+
+/**
+ * @brief NDFA::genRuleSwitchStep
+ * @param codeStr
+ * 多规则模式switch后端的单步转换：求出当前字符的下一状态next，无此边时为-1
+ */
+void NDFA::genRuleSwitchStep(QString &codeStr)
+{
+    codeStr+="\t\tnext = -1;\n"
+             "\t\tswitch (state) {\n";
+    for(int i=0;i<m_mDFAStateNum;i++)
+    {
+        const int *row=m_mDFATrans.constData()+i*m_classNum;
+        QString caseStr;
+        for(int c=0;c<m_classNum;c++)
+        {
+            if(row[c]<0 || c==m_otherClass)
+                continue;
+            QString label=classLabel(c);
+            label.replace("*/","* /");//避免提前结束注释
+            caseStr+="\t\t\tcase "+QString::number(c)+": /* "+label+" */ next = "+QString::number(row[c])+"; break;\n";
         }
+        if(row[m_otherClass]>=0)
+            caseStr+="\t\t\tdefault: next = "+QString::number(row[m_otherClass])+"; break;\n";
+        if(caseStr.isEmpty())
+            continue;
+        codeStr+="\t\tcase "+QString::number(i)+":\n"
+                 "\t\t\tswitch (ec[(unsigned char)*p]) {\n"+caseStr+
+                 "\t\t\t}\n"
+                 "\t\t\tbreak;\n";
     }
+    codeStr+="\t\t}\n";
 }
 
 /**
@@ -850,8 +2604,8 @@ void NDFA::DFA2mDFA()
  */
 QString NDFA::mDFA2Lexer(QString filePath)
 {
-    QStringList keywordList=m_reg_keyword_str.split('|');
-
+    QElapsedTimer timer;
+    timer.start();
     QString lexCode;
     int m_state=m_mDFAG.startState;//最小化DFA的初态
 
@@ -860,133 +2614,255 @@ QString NDFA::mDFA2Lexer(QString filePath)
              "#include<stdlib.h>\n"
              "#include<string.h>\n"
              "#include<ctype.h>\n"
-            "#include<set>\n"
-             "#include<unordered_map>\n";
-    //关键字映射map
-    lexCode+="std::set<std::string> keywordSet={};\n";
+             "#include<stdint.h>\n"
+             "#include<string>\n"
+             "#include<unordered_map>\n"
+             "#if defined(__unix__) || defined(__APPLE__)\n"
+             "#include<sys/mman.h>\n"
+             "#include<sys/stat.h>\n"
+             "#include<fcntl.h>\n"
+             "#include<unistd.h>\n"
+             "#ifndef LEX_NO_MMAP\n"
+             "#define LEX_USE_MMAP 1\n"
+             "#endif\n"
+             "#endif\n";
+    //关键字完美哈希表（多规则时关键字已是DFA中的规则）
+    if(!m_multiRule)
+        genKeywordHash(lexCode);
+
+    //输入整体读入内存：POSIX下内存映射（编译时定义LEX_NO_MMAP则不映射），否则一次读入缓冲区；分析时以指针前进/向前看
+    lexCode+="static const char* loadInput(const char* path, size_t* size) {\n"
+             "#ifdef LEX_USE_MMAP\n"
+             "\tint fd = open(path, O_RDONLY);\n"
+             "\tif (fd < 0) return NULL;\n"
+             "\tstruct stat st;\n"
+             "\tif (fstat(fd, &st) != 0) { close(fd); return NULL; }\n"
+             "\t*size = (size_t)st.st_size;\n"
+             "\tif (*size == 0) { close(fd); return \"\"; }\n"
+             "\tvoid* data = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);\n"
+             "\tclose(fd);\n"
+             "\tif (data == MAP_FAILED) return NULL;\n"
+             "\tmadvise(data, *size, MADV_SEQUENTIAL);\n"
+             "\treturn (const char*)data;\n"
+             "#else\n"
+             "\tFILE* fp = fopen(path, \"r\");\n"
+             "\tif (fp == NULL) return NULL;\n"
+             "\tfseek(fp, 0, SEEK_END);\n"
+             "\tlong cap = ftell(fp);\n"
+             "\tfseek(fp, 0, SEEK_SET);\n"
+             "\tchar* data = (char*)malloc(cap > 0 ? cap : 1);\n"
+             "\tif (data == NULL) { fclose(fp); return NULL; }\n"
+             "\t*size = fread(data, 1, cap, fp);\n"//文本方式读入，换行转换后实际长度可能更短
+             "\tfclose(fp);\n"
+             "\treturn data;\n"
+             "#endif\n"
+             "}\n"
+             "static void releaseInput(const char* data, size_t size) {\n"
+             "#ifdef LEX_USE_MMAP\n"
+             "\tif (size) munmap((void*)data, size);\n"
+             "#else\n"
+             "\tfree((void*)data);\n"
+             "#endif\n"
+             "}\n";
+    lexCode+="static void emitToken(FILE* output_fp, const char* prefix, const char* s, size_t len) {\n"
+             "\tfprintf(output_fp, \"%s%.*s \", prefix, (int)len, s);\n"
+             "\tprintf(\"%s%.*s \", prefix, (int)len, s);\n"
+             "}\n";
+
+    //字节→字符类映射表，状态转换按字符类号分支
+    lexCode+=QString("static const ")+(m_classNum>256 ? "unsigned short" : "unsigned char")+" ec[256] = {";
+    for(int b=0;b<256;b++)
+    {
+        if(b%16==0)lexCode+="\n\t";
+        lexCode+=QString::number(m_byteClass[b])+(b<255 ? "," : "");
+    }
+    lexCode+="\n};\n";
+    if(m_multiRule)
+        genRuleTables(lexCode);
+    else if(m_lexerBackend==TableBackend)
+        genLexTables(lexCode);
 
     //生成分析代码
-    lexCode+="void coding(FILE* input_fp,FILE* output_fp) {\n"
-             "\tchar tmp = fgetc(input_fp);\n"
+    lexCode+="void coding(const char*& p, const char* end, FILE* output_fp) {\n"
+             "\tchar tmp = *p;\n"
              "\tif (tmp == ' ' || tmp == '\\n' || tmp == '\\t'){\n"
-             "\t\tfprintf(output_fp, \"%c\", tmp);\n"
-             "\t\tprintf(\"%c\", tmp);\n"
+             "\t\tfputc(tmp, output_fp);\n"
+             "\t\tputchar(tmp);\n"
+             "\t\tp++;\n"
              "\t\treturn;\n"
              "\t}\n"
-             "\tungetc(tmp, input_fp);\n"
-             "\tint state = "+QString::number(m_state)+";\n"
-             "\tbool flag = false;\n"
-             "\tbool isIdentifier = false;\n"
-            "\tbool isDigit = false;\n"
-             "\tbool isAnnotation = false;\n"
-             "\tstd::string value;\n"
-             "\twhile (!flag) {\n"
-             "\t\ttmp = fgetc(input_fp);\n"
-             "\t\tswitch (state) {\n";
-
-    for(int i=0;i<m_mDFAStateNum;i++)
+             "\tconst char* begin = p;\n"
+             "\tint state = "+QString::number(m_state)+";\n";
+    if(m_multiRule)
     {
-        if(m_mDFANodeArr[i].mDFAEdgesMap.size()){
-            lexCode+="\t\tcase "+QString::number(i)+": {\n";
-            lexCode+="\t\t\tswitch (tmp) {\n";
-            QList<QString> tmpList=m_mDFANodeArr[i].mDFAEdgesMap.keys();//该状态的所有边值
-            if(genLexCase(tmpList,lexCode,i,1))
-                lexCode+="\t\t\tdefault:state = "+QString::number(m_mDFANodeArr[i].mDFAEdgesMap["~"])+"; isAnnotation = true; break;\n";
-            lexCode+="\t\t\t}\n";
-            lexCode+="\t\t\tbreak;\n";
-            lexCode+="\t\t}\n";
-        }
+        //最长匹配：记录最近经过的终态及其规则号，无法继续转换时回退到该处，由规则号直接确定单词类别
+        lexCode+="\tconst char* lastEnd = NULL;\n"
+                 "\tint lastRule = -1;\n"
+                 "\twhile (p < end) {\n"
+                 "\t\tint next;\n";
+        if(m_lexerBackend==TableBackend)
+            lexCode+="\t\tnext = trans[state][ec[(unsigned char)*p]];\n";
+        else
+            genRuleSwitchStep(lexCode);
+        lexCode+="\t\tif (next < 0) break;\n"
+                 "\t\tstate = next;\n"
+                 "\t\tp++;\n"
+                 "\t\tif (accept[state] >= 0) {\n"
+                 "\t\t\tlastRule = accept[state];\n"
+                 "\t\t\tlastEnd = p;\n"
+                 "\t\t}\n"
+                 "\t}\n"
+                 "\tif (lastRule < 0) {\n"//没有任何规则匹配，输出该字符后跳过
+                 "\t\tp = begin + 1;\n"
+                 "\t\temitToken(output_fp, \"Error:\", begin, 1);\n"
+                 "\t\treturn;\n"
+                 "\t}\n"
+                 "\tp = lastEnd;\n"
+                 "\tif (!ruleSkip[lastRule])\n"
+                 "\t\temitToken(output_fp, ruleName[lastRule], begin, p - begin);\n"
+                 "};\n";
     }
-    lexCode+="\t\t}\n";
-    lexCode+="\t\tvalue += tmp;\n";
-
-    QList<int> stateList=m_mDFAG.endStateSet.values();//所有终态
-
-    lexCode+="\t\tif (";
-    for(int i=0;i<stateList.size();i++)
+    else
     {
-        //要提前读一个字符判断是不是真的到终态，因为到了终态不一定是真正的终态
-        int num=stateList[i];
-        if(i)lexCode+="\t\telse if (";
-        lexCode+="state =="+QString::number(num)+") {\n";
-        lexCode+="\t\t\ttmp = fgetc(input_fp);\n";
-        lexCode+="\t\t\tswitch (tmp) {\n";
-        QList<QString> tmpList=m_mDFANodeArr[num].mDFAEdgesMap.keys();//该状态的所有边值
-        genLexCase(tmpList,lexCode,num,0);
-        lexCode+="\t\t\tdefault: {\n";
-        lexCode+="\t\t\t\tflag=true;\n";
-        if(tmpList.contains("letter"))
-            lexCode+="\t\t\t\tisIdentifier = true;\n";
-        lexCode+="\t\t\t}\n"
-                 "\t\t\t}\n"
-                 "\t\t\tungetc(tmp, input_fp);\n"
-                 "\t\t}\n";
+        lexCode+="\tbool flag = false;\n"
+                 "\tbool isIdentifier = false;\n"
+                "\tbool isDigit = false;\n"
+                 "\tbool isAnnotation = false;\n"
+                 "\twhile (!flag) {\n"
+                 "\t\tif (p == end) break;\n"//输入结束，当前单词到此为止
+                 "\t\ttmp = *p++;\n";
+        if(m_lexerBackend==TableBackend)
+            genTableLoop(lexCode);
+        else
+            genSwitchLoop(lexCode);
+        lexCode+="\t}\n";
+
+        //为适配解码增加Keyword:前缀，数字Digit:前缀，ID:标识符前缀
+
+        //单词即[begin,p)区间，不再逐字符拼接
+        lexCode+="\tsize_t len = p - begin;\n"
+                "\tif (isKeyword(begin, len)) {\n"
+                "\t\temitToken(output_fp, \"Keyword:\", begin, len);\n"
+                "\t\treturn;\n"
+                "\t}\n"
+                "\tif (isIdentifier) {\n"
+                "\t\temitToken(output_fp, \"ID:\", begin, len);\n"
+                "\t\treturn;\n"
+                "\t}\n"
+                "\tif (isDigit) {\n"
+                "\t\temitToken(output_fp, \"Digit:\", begin, len);\n"
+                "\t\treturn;\n"
+                "\t}\n"
+                "\tif (!isAnnotation) {\n"
+                "\t\temitToken(output_fp, \"\", begin, len);\n"
+                "\t}\n"
+                "};\n";
     }
-    lexCode+="\t}\n";
-
-    //为适配解码增加Keyword:前缀，数字Digit:前缀，ID:标识符前缀
-
-    lexCode+="\tif (keywordSet.count(value)) {\n"
-            "\t\tfprintf(output_fp, \"Keyword:%s \", value.c_str());\n"
-            "\t\tprintf(\"Keyword:%s \", value.c_str());\n"
-            "\t\treturn;\n"
-            "\t}\n"
-            "\tif (isIdentifier) {\n"
-            "\t\tfprintf(output_fp, \"ID:%s \", value.c_str());\n"
-            "\t\tprintf(\"ID:%s \", value.c_str());\n"
-            "return;\n"
-            "\t}\n"
-            "\tif (isDigit) {\n"
-            "\t\tfprintf(output_fp, \"Digit:%s \", value.c_str());\n"
-            "\t\tprintf(\"Digit:%s \", value.c_str());\n"
-            "\t\treturn;\n"
-            "\t}\n"
-            "\tif (!isAnnotation) {\n"
-            "\t\tfprintf(output_fp, \"%s \", value.c_str());\n"
-            "\t\tprintf(\"%s \", value.c_str());\n"
-            "\t}\n"
-            "};\n";
-
-    //主函数
+
+    //主函数：可由命令行参数指定输入、输出文件，缺省为生成时的路径
     QFileInfo fileInfo(filePath);
     QString t_tmpFilePath=fileInfo.path();
     lexCode+="int main(int argc, char* argv[]) {\n"
-             "\tFILE* input_fp = fopen(\""+filePath+"/_sample.tny\", \"r\");\n"
-             "\tif (input_fp == NULL) {\n"
+             "\tconst char* input_path = argc > 1 ? argv[1] : \""+filePath+"/_sample.tny\";\n"
+             "\tconst char* output_path = argc > 2 ? argv[2] : \""+t_tmpFilePath+"/output.lex"+"\";\n"
+             "\tsize_t size = 0;\n"
+             "\tconst char* data = loadInput(input_path, &size);\n"
+             "\tif (data == NULL) {\n"
              "\t\tprintf(\"Failed to open input file\");\n"
              "\t\treturn 1;\n"
              "\t}\n";
 
-    lexCode+="\tFILE* output_fp = fopen(\""+t_tmpFilePath+"/output.lex"+"\", \"w\");\n"
+    lexCode+="\tFILE* output_fp = fopen(output_path, \"w\");\n"
              "\tif (output_fp == NULL) {\n"
              "\t\tprintf(\"Failed to open output file\");\n"
-             "\t\tfclose(input_fp);\n"
+             "\t\treleaseInput(data, size);\n"
              "\t\treturn 1;\n"
-             "\t}\n";
-
-
-    lexCode+="keywordSet = { ";
-    for(const auto &tmp : keywordList)
-    {
-        lexCode+="\""+tmp+"\",";
-    }
-    lexCode.chop(1);
-    lexCode+=" };\n";
+             "\t}\n"
+             "\tsetvbuf(output_fp, NULL, _IOFBF, 1 << 16);\n"
+             "\tsetvbuf(stdout, NULL, _IOFBF, 1 << 16);\n";
 
-    lexCode+="\tchar c;\n"
-             "\twhile ((c=fgetc(input_fp)) != EOF) {\n"
-             "\t\tungetc(c, input_fp);\n"
-             "\t\tcoding(input_fp, output_fp);\n"
+    lexCode+="\tconst char* p = data;\n"
+             "\tconst char* end = data + size;\n"
+             "\twhile (p < end) {\n"
+             "\t\tcoding(p, end, output_fp);\n"
              "\t}\n"
-             "\tfclose(input_fp);\n"
+             "\treleaseInput(data, size);\n"
              "\tfclose(output_fp);\n"
              "\treturn 0;\n"
              "}";
 
     m_lexerCodeStr=lexCode;
+    m_phaseStats.lexerBytes=lexCode.size();
+    m_phaseStats.phaseNs[LexerPhase]=timer.nsecsElapsed();
     return lexCode;
 }
 
+/**
+ * @brief NDFA::exportTable
+ * @return 最小化DFA的稠密转换表
+ * 需在DFA2mDFA之后调用；“~”边展开到没有显式边的字符类上，与生成的词法分析程序一致。
+ * 单条正则表达式时只有规则0
+ */
+LexTable NDFA::exportTable() const
+{
+    LexTable table;
+    table.stateNum=m_mDFAStateNum;
+    table.classNum=m_classNum;
+    table.startState=m_mDFAStateNum ? m_mDFAG.startState : -1;
+    table.byteClass=m_byteClass;
+    table.trans=m_mDFATrans;
+    for(int i=0;i<m_mDFAStateNum;i++)
+    {
+        int otherTo=m_mDFATrans[i*m_classNum+m_otherClass];
+        for(int c=0;c<m_classNum;c++)
+            if(table.trans[i*m_classNum+c]<0)
+                table.trans[i*m_classNum+c]=otherTo;
+    }
+    table.accept=m_mDFAAccept;
+    table.ruleNames=m_ruleNames;
+    table.ruleSkip=m_ruleSkip;
+    for(const auto &keyword: m_reg_keyword_str.split('|'))
+        if(!keyword.isEmpty() && !table.keywords.contains(keyword))
+            table.keywords.append(keyword);
+    return table;
+}
+
+/**
+ * @brief NDFA::exportNFA
+ * @return 扁平化的NFA
+ * 导出reg2NFA/rules2NFA得到的NFA，非epsilon边与epsilon边均压成连续数组，
+ * 无需NFA2DFA即可交由LazyDFA边扫描边确定化
+ */
+LexNFA NDFA::exportNFA() const
+{
+    LexNFA nfa;
+    nfa.stateNum=m_NFAStateNum;
+    nfa.startState=m_NFAG.startState;
+    nfa.classNum=m_classNum;
+    nfa.otherClass=m_otherClass;
+    nfa.byteClass=m_byteClass;
+    nfa.edgeOff.append(0);
+    nfa.epsOff.append(0);
+    for(int state=0;state<m_NFAStateNum;state++)
+    {
+        const NFANode &node=m_NFAStateArr[state];
+        nfa.toState.append(node.toState);
+        if(node.toState>=0)
+            nfa.edgeClasses.append(m_symbolClasses[node.symbol]);
+        nfa.edgeOff.append(nfa.edgeClasses.size());
+        nfa.epsOff.append(m_NFAEpsOff[state+1]);
+        nfa.acceptRule.append(node.acceptRule);
+    }
+    nfa.epsTo=m_NFAEpsTo;
+    nfa.acceptStates=m_NFAAcceptStates;
+    nfa.ruleNames=m_ruleNames;
+    nfa.ruleSkip=m_ruleSkip;
+    for(const auto &keyword: m_reg_keyword_str.split('|'))
+        if(!keyword.isEmpty() && !nfa.keywords.contains(keyword))
+            nfa.keywords.append(keyword);
+    return nfa;
+}
+
 void NDFA::setPath(QString srcFilePath, QString tmpFilePath)
 {
     this->m_srcFilePath=srcFilePath;//源程序文件路径
@@ -997,3 +2873,126 @@ void NDFA::setKeywordStr(QString kStr)
 {
     this->m_reg_keyword_str=kStr;
 }
+
+const NDFA::PhaseStats &NDFA::phaseStats() const
+{
+    return m_phaseStats;
+}
+
+/**
+ * @brief NDFA::PhaseStats::summary
+ * @param phase
+ * @return 该阶段的状态数、边数、计数与耗时
+ */
+QString NDFA::PhaseStats::summary(Phase phase) const
+{
+    const QString ms=QString::number(phaseNs[phase]/1e6, 'f', 3)+" ms";
+    switch(phase)
+    {
+    case NFAPhase:
+        if(positionNum>0)
+            return QString("followpos: %1个位置，followpos共%2项，%3个操作符→%4个字符类，约%5 KiB，%6")
+                    .arg(positionNum).arg(followposNum).arg(symbolNum).arg(classNum)
+                    .arg(NFABytes/1024).arg(ms);
+        return QString("NFA: %1个状态，%2条边，%3条epsilon边，%4个操作符→%5个字符类，约%6 KiB，%7")
+                .arg(NFAStateNum).arg(NFAEdgeNum).arg(NFAEpsEdgeNum).arg(symbolNum).arg(classNum)
+                .arg(NFABytes/1024).arg(ms);
+    case DFAPhase:
+        return QString("DFA: %1个状态，%2条边，求闭包%3次，索引查询%4次，约%5 KiB，%6")
+                .arg(DFAStateNum).arg(DFAEdgeNum).arg(closureNum).arg(DFAIndexLookups)
+                .arg(DFABytes/1024).arg(ms);
+    case mDFAPhase:
+        return QString("mDFA: %1个状态，%2条边，划分分裂%3次，求精%4轮，约%5 KiB，%6")
+                .arg(mDFAStateNum).arg(mDFAEdgeNum).arg(partitionSplits).arg(refineRounds)
+                .arg(mDFABytes/1024).arg(ms);
+    case LexerPhase:
+        return QString("Lexer: 代码%1字符，%2").arg(lexerBytes).arg(ms);
+    }
+    return QString();
+}
+
+/**
+ * @brief NDFA::PhaseStats::arenaSummary
+ * @return 各阶段从编译内存池分配的次数、累计字节数与当前占用的系统内存
+ */
+QString NDFA::PhaseStats::arenaSummary() const
+{
+    return QString("内存池: NFA分配%1次，DFA分配%2次，mDFA分配%3次，共%4 KiB，占用系统内存%5块（%6 KiB）")
+            .arg(arenaAllocs[NFAPhase]).arg(arenaAllocs[DFAPhase]).arg(arenaAllocs[mDFAPhase])
+            .arg(arenaBytes/1024).arg(arenaBlocks).arg(arenaBlockBytes/1024);
+}
+
+/**
+ * @brief NDFA::PhaseStats::toJson
+ * @return 按阶段分组的统计信息，耗时单位为毫秒
+ */
+QJsonObject NDFA::PhaseStats::toJson() const
+{
+    auto ms=[this](Phase phase){
+        return phaseNs[phase]/1e6;
+    };
+    QJsonObject NFA{{"states", NFAStateNum}, {"edges", NFAEdgeNum}, {"epsEdges", NFAEpsEdgeNum},
+                    {"positions", positionNum}, {"followpos", followposNum},
+                    {"symbols", symbolNum}, {"classes", classNum}, {"rules", ruleNum},
+                    {"bytes", NFABytes}, {"ms", ms(NFAPhase)}};
+    QJsonObject DFA{{"states", DFAStateNum}, {"edges", DFAEdgeNum}, {"closures", closureNum},
+                    {"indexLookups", DFAIndexLookups}, {"indexInserts", DFAIndexInserts},
+                    {"bytes", DFABytes}, {"ms", ms(DFAPhase)}};
+    QJsonObject mDFA{{"states", mDFAStateNum}, {"edges", mDFAEdgeNum}, {"partitionSplits", partitionSplits},
+                     {"refineRounds", refineRounds}, {"bytes", mDFABytes}, {"ms", ms(mDFAPhase)}};
+    QJsonObject lexer{{"codeChars", lexerBytes}, {"ms", ms(LexerPhase)}};
+    QJsonObject arena{{"NFAAllocs", arenaAllocs[NFAPhase]}, {"DFAAllocs", arenaAllocs[DFAPhase]},
+                      {"mDFAAllocs", arenaAllocs[mDFAPhase]}, {"bytes", arenaBytes},
+                      {"blocks", arenaBlocks}, {"blockBytes", arenaBlockBytes}};
+    return QJsonObject{{"NFA", NFA}, {"DFA", DFA}, {"mDFA", mDFA}, {"lexer", lexer}, {"arena", arena}};
+}
+
+void NDFA::setConstructEngine(ConstructEngine engine)
+{
+    this->m_constructEngine=engine;
+}
+
+NDFA::ConstructEngine NDFA::constructEngine() const
+{
+    return m_constructEngine;
+}
+
+void NDFA::setMinimizeEngine(MinimizeEngine engine)
+{
+    this->m_minimizeEngine=engine;
+}
+
+NDFA::MinimizeEngine NDFA::minimizeEngine() const
+{
+    return m_minimizeEngine;
+}
+
+void NDFA::setLexerBackend(LexerBackend backend)
+{
+    this->m_lexerBackend=backend;
+}
+
+NDFA::LexerBackend NDFA::lexerBackend() const
+{
+    return m_lexerBackend;
+}
+
+void NDFA::setDeterminizeThreads(int threadNum)
+{
+    this->m_determinizeThreads=qMax(1, threadNum);
+}
+
+int NDFA::determinizeThreads() const
+{
+    return m_determinizeThreads;
+}
+
+void NDFA::setProgressHandler(ProgressHandler handler)
+{
+    this->m_progressHandler=handler;
+}
+
+void NDFA::setCancelFlag(const QAtomicInt *flag)
+{
+    this->m_cancelFlag=flag;
+}
@@ -18,21 +18,31 @@
 #ifndef NDFA_H
 #define NDFA_H
 
+#include<QAtomicInt>
 #include<QFileInfo>
-#include<QHeaderView>
+#include<QHash>
+#include<QJsonObject>
 #include<QList>
 #include<QMap>
-#include<QMessageBox>
 #include<QQueue>
 #include<QSet>
 #include<QStack>
-#include<QTableWidget>
+#include<QStringList>
+#include<QThreadPool>
+
+//仅在链接了QtWidgets的工程（图形界面）中提供文本框输出，命令行工具只依赖QtCore
+#ifdef QT_WIDGETS_LIB
 #include<QPlainTextEdit>
+#endif
 
+#include<functional>
 #include<set>
 
-#define ARR_MAX_SIZE 1024 //定义存储节点数组大小上限
-#define ARR_TEMP_SIZE 128 //定义临时结构体数组大小
+#include "lazydfa.h"
+#include "lexarena.h"
+#include "lexscanner.h"
+#include "stateset.h"
+
 #define DFA_NODE_EDGE_COUNT 16 //定义DFA节点的边数上限
 
 class NDFA
@@ -44,23 +54,25 @@ public:
     {
         int stateNum;//当前NFA节点状态（号）
         int toState;//通过非epsilon边转换到的状态号
-        QString value;//非epsilon的NFA状态弧上的值
-        QSet<int> epsToSet;//状态号集合，即当前状态通过epsilon边转移到的状态的 状态号集合
+        int symbol;//非epsilon的NFA状态弧上的操作符编号
+        int acceptRule;//若为某条规则的终态，记录规则号，否则为-1
+        //epsilon边不存于节点中，构造时记入边表，构造完成后冻结为CSR数组（见freezeNFA）
 
         void init()//初始化函数
         {
             stateNum=-1;
             toState=-1;
-            value=' ';
-            epsToSet.clear();
+            symbol=-1;
+            acceptRule=-1;
         }
     };
 
     //NFA子图结构体
+    //节点数组会随状态数增长而重新分配，故记录状态号而非节点指针
     struct NFAGraph
     {
-        NFANode* startNode;//NFA头指针
-        NFANode* endNode;//NFA尾指针
+        int startState;//NFA头节点状态号
+        int endState;//NFA尾节点状态号
     };
 
     //DFA节点结构体
@@ -68,14 +80,12 @@ public:
     {
         int stateNum;//DFA状态号
 
-        QSet<int> NFANodeSet;//存储当前DFA节点包含的NFA节点序号
-        QMap<QString, int> DFAEdgeMap;//存储当前DFA节点的边——节点映射
+        StateSet NFANodeSet;//存储当前DFA节点包含的NFA节点序号（位图）
 
         void init()
         {
             stateNum=-1;
             NFANodeSet.clear();
-            DFAEdgeMap.clear();
         }
     };
 
@@ -84,12 +94,10 @@ public:
     struct mDFANode
     {
         QSet<int> DFAStatesSet;//存储当前最小化DFA节点包含DFA节点序号的集合
-        QMap<QString, int> mDFAEdgesMap;//当前最小化DFA节点通过某操作符到达最小化DFA节点序号
 
         void init()
         {
             DFAStatesSet.clear();
-            mDFAEdgesMap.clear();
         }
     };
 
@@ -99,6 +107,83 @@ public:
         QSet<int> endStateSet;//最小化DFA的终态集
     };
 
+    //转换的各个阶段
+    enum Phase
+    {
+        NFAPhase,//reg2NFA / rules2NFA
+        DFAPhase,//NFA2DFA
+        mDFAPhase,//DFA2mDFA
+        LexerPhase//mDFA2Lexer
+    };
+
+    //转换各阶段的统计信息
+    struct PhaseStats
+    {
+        int NFAStateNum;//NFA状态数
+        int DFAStateNum;//DFA状态数
+        int mDFAStateNum;//最小化DFA状态数
+        int DFAIndexLookups;//子集构造中查询 状态集→DFA状态号 索引的次数
+        int DFAIndexInserts;//向索引插入新状态集的次数（即新建的DFA状态数）
+        int symbolNum;//正则表达式中的操作符数
+        int classNum;//压缩后的输入字符类数
+        int ruleNum;//词法规则数（含关键字）
+
+        int positionNum;//followpos构造的位置数（含各规则的结束标记），Thompson构造时为0
+        qint64 followposNum;//各位置followpos集合的元素总数
+        int NFAEdgeNum;//NFA非epsilon边数
+        int NFAEpsEdgeNum;//NFA epsilon边数
+        int DFAEdgeNum;//DFA边数（按字符类计）
+        int mDFAEdgeNum;//最小化DFA边数（按字符类计）
+        qint64 closureNum;//求epsilon闭包的次数
+        qint64 partitionSplits;//最小化中划分被分裂的次数
+        qint64 refineRounds;//最小化的求精轮数（原算法为遍历轮数，Hopcroft为处理的分割集数）
+        qint64 NFABytes;//NFA主要数据结构占用的字节数（估计，下同）
+        qint64 DFABytes;//DFA状态集、转换表与闭包缓存
+        qint64 mDFABytes;//最小化DFA的划分与转换表
+        qint64 lexerBytes;//生成的词法分析程序代码长度
+        qint64 phaseNs[LexerPhase+1];//各阶段耗时（纳秒）
+        qint64 arenaAllocs[LexerPhase+1];//各阶段从编译内存池分配的次数
+        qint64 arenaBytes;//编译内存池累计分配的字节数（自上次init起，下同）
+        qint64 arenaBlocks;//编译内存池当前占用的系统内存块数（阶段结束时）
+        qint64 arenaBlockBytes;//编译内存池当前占用的系统内存字节数
+
+        void init()
+        {
+            NFAStateNum=0;
+            DFAStateNum=0;
+            mDFAStateNum=0;
+            DFAIndexLookups=0;
+            DFAIndexInserts=0;
+            symbolNum=0;
+            classNum=0;
+            ruleNum=0;
+            positionNum=0;
+            followposNum=0;
+            NFAEdgeNum=0;
+            NFAEpsEdgeNum=0;
+            DFAEdgeNum=0;
+            mDFAEdgeNum=0;
+            closureNum=0;
+            partitionSplits=0;
+            refineRounds=0;
+            NFABytes=0;
+            DFABytes=0;
+            mDFABytes=0;
+            lexerBytes=0;
+            for(auto &ns: phaseNs)
+                ns=0;
+            for(auto &allocs: arenaAllocs)
+                allocs=0;
+            arenaBytes=0;
+            arenaBlocks=0;
+            arenaBlockBytes=0;
+        }
+
+        QString summary(Phase phase) const;//某阶段的一行摘要，供控制台输出
+        QString arenaSummary() const;//编译内存池的分配统计
+        QJsonObject toJson() const;//全部统计信息，按阶段分组
+    };
+
     //状态集结构体
     struct stateSet
     {
@@ -106,44 +191,145 @@ public:
         int stateSetId;//所属状态集合号
     };
 
+    //后缀式正则表达式的记号
+    struct RegexToken
+    {
+        QChar op;//运算符'|'、'&'、'*'、'+'、'?'，为空（isNull）时是操作符
+        int symbol;//操作符编号
+    };
+
+    //词法规则：规则在列表中的顺序即优先级，靠前者优先
+    struct LexRule
+    {
+        QString name;//单词类别名，生成的词法分析程序以“name:”为前缀输出
+        QString regex;//正则表达式
+        bool skip;//识别后不输出（如注释）
+    };
+
+    //由正则表达式构造DFA的方式
+    enum ConstructEngine
+    {
+        ThompsonConstruct,//Thompson构造NFA后子集构造（默认）
+        FollowposConstruct//由语法树求followpos直接构造DFA，不经epsilon边与闭包
+    };
+
+    //DFA最小化算法
+    enum MinimizeEngine
+    {
+        HopcroftMinimize,//Hopcroft划分求精（默认）
+        IterativeMinimize//原有的逐轮划分算法，保留用于对比
+    };
+
+    //生成的词法分析程序的实现方式
+    enum LexerBackend
+    {
+        SwitchBackend,//嵌套switch分支（默认）
+        TableBackend//静态转换表+查表循环
+    };
+
+    //转换进度回调：阶段与当前规模（DFA为已发现的状态数，mDFA为当前划分数），在执行转换的线程中调用
+    typedef std::function<void(Phase phase, int count)> ProgressHandler;
+
 public:
     NDFA();
     void init();//初始化类
 
     NFAGraph strToNfa(QString s);//将正则表达式转换为NFA
+    QList<RegexToken> regexToPostfix(const QString &s);//将正则表达式解析为后缀式
+    NFAGraph postfixToNfa(const QList<RegexToken> &postfix);//由后缀式构造NFA
     void opPriorityMapInit();//初始化操作符优先级
-    void insConnOp(QString str,int curState,QStack<QChar> &opStack,QStack<NFAGraph> &NFAStack);//判断是否需要插入连接&符号
-    void pushOpStackProcess(QChar ch,QStack<QChar> &opStack,QStack<NFAGraph> &NFAStack);//运算符入栈处理子函数
-    void opProcess(QChar ch,QStack<NFAGraph> &NFAStack);//根据运算符转换NFA处理子函数
+    void insConnOp(const QString &str,int curState,QStack<QChar> &opStack,QList<RegexToken> &postfix);//判断是否需要插入连接&符号
+    bool expandRepeat(QList<RegexToken> &postfix, int minCount, int maxCount);//将后缀式末尾的子表达式按计数重复展开，超过长度上限时返回false
+    static int postfixDepth(const QList<RegexToken> &postfix);//后缀式求值后剩余的子表达式数，某运算符缺少操作数时为-1
+    void pushOpStackProcess(QChar ch,QStack<QChar> &opStack,QList<RegexToken> &postfix);//运算符入栈处理子函数
+    void opProcess(QChar ch,ArenaVector<NFAGraph> &NFAStack);//根据运算符转换NFA处理子函数
+
 
 
+    //状态转换表的按需读取（phase为NFAPhase、DFAPhase或mDFAPhase），供图形界面的表格模型使用
+    int tableRowCount(Phase phase) const;
+    int tableColumnCount(Phase phase) const;
+    QString tableHeader(Phase phase, int column) const;
+    QString tableCell(Phase phase, int row, int column) const;
 
-    void printNFA(QTableWidget *table);//输出NFA状态转换表
-    void printDFA(QTableWidget *table);//输出DFA状态转换表
-    void printMDFA(QTableWidget *table);//输出mDFA状态转换表
+#ifdef QT_WIDGETS_LIB
     void printLexer(QPlainTextEdit *widget);//输出Lexer（词法分析程序）代码
+#endif
 
 public:
-    NFAGraph createNFA(int sum);//按顺序新建一个NFA子图
-    void add(NFANode *n1, NFANode *n2, QString ch);//n1、n2节点间添加非eps边
-    void add(NFANode *n1, NFANode *n2);//n1、n2节点间添加eps边
-
-
-    void reg2NFA(QString regStr);//正则表达式转换位NFA
-    void NFA2DFA();//NFA转换为DFA
-    void DFA2mDFA();//DFA的最小化
+    int newNFANode();//新建一个NFA节点，返回其状态号
+    NFAGraph createNFA();//按顺序新建一个NFA子图
+    void add(int n1, int n2, int symbol);//n1、n2节点间添加非eps边
+    void add(int n1, int n2);//n1、n2节点间添加eps边
+
+
+    bool reg2NFA(QString regStr);//正则表达式转换位NFA，正则表达式有误时返回false
+    bool rules2NFA(const QList<LexRule> &rules);//多条词法规则合并转换为一个NFA，有误时返回false
+    const QString &errorString() const;//最近一次reg2NFA/rules2NFA失败的原因
+    void precomputeClosures();//求出并缓存所有NFA状态的epsilon闭包（NFA2DFA按需求，可提前调用）
+    bool NFA2DFA();//NFA转换为DFA，被中止时返回假
+    bool DFA2mDFA();//DFA的最小化，被中止时返回假
     QString mDFA2Lexer(QString filePath);//最小化DFA生成Lexer
+    LexTable exportTable() const;//导出最小化DFA，供LexScanner在进程内直接扫描
+    LexNFA exportNFA() const;//导出NFA（边换算为字符类），供LazyDFA按需确定化
 
 public:
     void setPath(QString srcFilePath, QString tmpFilePath);
     void setKeywordStr(QString kStr);
+    void setConstructEngine(ConstructEngine engine);//选择DFA的构造方式，须在reg2NFA/rules2NFA之前设置
+    ConstructEngine constructEngine() const;
+    void setMinimizeEngine(MinimizeEngine engine);//选择DFA最小化算法
+    MinimizeEngine minimizeEngine() const;
+    void setLexerBackend(LexerBackend backend);//选择词法分析程序的生成方式
+    LexerBackend lexerBackend() const;
+    void setDeterminizeThreads(int threadNum);//子集构造的工作线程数，1为单线程
+    int determinizeThreads() const;
+    void setProgressHandler(ProgressHandler handler);//设置转换进度回调，为空则不报告
+    void setCancelFlag(const QAtomicInt *flag);//设置中止标志，其他线程将其置为非0即请求中止转换
+    const PhaseStats &phaseStats() const;//取得最近一次转换的统计信息
+
+    static bool isRuleFile(const QStringList &lines);//是否为多规则格式（首行为%rules）
+    static bool parseRules(const QStringList &lines, QList<LexRule> &rules, QString &keywordStr, QString &errorStr);//解析多规则格式
 
 private:
-    void get_e_closure(QSet<int> &tmpSet);//求epsilon闭包
-
-    int getStateId(QSet<int> set[],int cur);//查询当前DFA节点属于哪个状态集（号）
-
-    bool genLexCase(QList<QString> tmpList, QString &codeStr, int idx, bool flag);
+    void get_e_closure(StateSet &tmpSet);//求epsilon闭包
+    const StateSet &stateClosure(int state);//单个NFA状态的epsilon闭包（缓存）
+    int newDFANode(const StateSet &NFANodeSet);//新建一个DFA节点，返回其状态号
+    void clearNFA();//清除NFA及操作符表、规则表
+    void clearDFA();//清除上一次的DFA，重新确定化前调用
+    void clearMDFA();//清除上一次的最小化DFA
+    bool checkProgress(Phase phase, int count);//报告进度，返回是否继续
+    bool cancelRequested() const;//是否已请求中止（只读，可在工作线程中调用）
+    bool NFA2DFASerial();//单线程子集构造
+    bool NFA2DFAParallel();//按层并行的子集构造
+    bool NFA2DFAFollowpos();//由followpos集合构造DFA
+    void computeFollowpos(const QList<QList<RegexToken>> &rulePostfix);//求各规则的firstpos/lastpos与全部followpos
+    QList<RegexToken> literalToPostfix(const QString &literal);//将字面串（关键字）转换为后缀式
+    int acceptRuleOf(const StateSet &set) const;//DFA状态（NFA状态集或位置集）接受的规则号
+    void expandDFAState(const StateSet &NFANodeSet, QList<StateSet> &chToSetArr,
+                        QList<int> &classes, QList<StateSet> &targets) const;//求DFA状态各字符类的move+closure（只读）
+    NFAGraph literalToNfa(const QString &literal);//将字面串（关键字）转换为NFA
+    void setAcceptRule(int state, int rule);//将NFA状态标记为某规则的终态
+    QString acceptLabel(int rule) const;//终态在表格中的显示
+    int internSymbol(const QString &symbol);//取得操作符编号，首次出现时登记
+    void buildSymbolClasses();//将输入字节划分为等价的字符类
+    void freezeNFA();//将epsilon边表冻结为CSR数组
+    void recordNFAStats();//统计NFA的规模
+    void recordArenaStats(Phase phase, qint64 allocsBefore);//记录本阶段及累计的内存池分配统计
+    QList<int> symbolClasses(const QString &symbol) const;//操作符覆盖的字符类号
+    QString classLabel(int classId) const;//字符类的显示名
+
+    int getStateId(const QList<QSet<int>> &set,int cur);//查询当前DFA节点属于哪个状态集（号）
+    bool divideIterative();//原有划分算法求DFA状态等价划分
+    bool divideHopcroft();//Hopcroft算法求DFA状态等价划分
+
+    bool genLexCase(QList<int> classList, QString &codeStr, int idx, bool flag);
+    void genSwitchLoop(QString &codeStr);//switch后端的分析循环
+    void genLexTables(QString &codeStr);//表驱动后端的静态转换表
+    void genTableLoop(QString &codeStr);//表驱动后端的分析循环
+    void genKeywordHash(QString &codeStr);//关键字完美哈希表
+    void genRuleSwitchStep(QString &codeStr);//多规则模式switch后端的单步转换
+    void genRuleTables(QString &codeStr);//多规则模式的规则名、终态规则号等静态表
 
 private:
     QString m_reg_keyword_str;//关键字正则串
@@ -153,22 +339,69 @@ private:
     QString m_tmpFilePath;//词法分析程序输出路径
 
     QSet<QString> m_keyWordSet;//关键字集合
-    QSet<QString> m_opCharSet;//操作符集合
+    QStringList m_opCharList;//操作符表，下标即操作符编号（按在正则表达式中首次出现的顺序）
+    QHash<QString, int> m_opCharIdx;//操作符→编号
     QSet<QChar> m_opSet={'(',')','|','*','+','?'};//运算符集合
 
+    //输入字符等价类：在所有操作符上表现相同的字节归为一类，DFA按字符类号构造
+    QList<int> m_byteClass;//字节(0~255)→字符类号
+    QList<QList<int>> m_classBytes;//字符类→所含字节（独立成类的多字符操作符为空）
+    QList<QList<int>> m_symbolClasses;//操作符编号→其覆盖的字符类号
+    int m_classNum;//字符类数
+    int m_otherClass;//不被任何操作符覆盖的字节所在的类，“~”边亦归于此类
+
     QSet<int> m_DFAEndStateSet;//存储DFA终态状态号集合
-    QSet<int> m_dividedSet[ARR_MAX_SIZE]; //划分出来的集合数组，存储DFA状态号集的数组（最小化DFA时用到的）
+
+    //词法规则（单条正则表达式时只有一条规则）
+    bool m_multiRule;//是否为多规则模式，生成的词法分析程序按规则号分类单词
+    QStringList m_ruleNames;//规则号→单词类别名
+    QList<bool> m_ruleSkip;//规则号→是否不输出
+    QList<int> m_NFAAcceptStates;//各规则的NFA终态，按规则号（优先级）排列
+    QList<int> m_DFAAccept;//DFA状态→接受的规则号，-1为非终态
+    QList<int> m_mDFAAccept;//mDFA状态→接受的规则号，-1为非终态
+    QList<QSet<int>> m_dividedSet; //划分出来的集合数组，存储DFA状态号集的数组（最小化DFA时用到的）
 
     QMap<QChar, int> opPriorityMap;//存储运算符优先级
 
-    NFANode m_NFAStateArr[ARR_MAX_SIZE];//NFA状态数组
-    DFANode m_DFAStateArr[ARR_MAX_SIZE];//DFA状态数组
-    mDFANode m_mDFANodeArr[ARR_MAX_SIZE];//mDFA状态数组
+    //编译内存池：状态集位图等从此分配，须声明在使用它的容器之前，析构时最后释放
+    LexArena m_arena;
+
+    //状态数组按实际自动机规模增长，不设上限
+    QList<NFANode> m_NFAStateArr;//NFA状态数组
+    QList<int> m_NFAEpsFrom;//构造中的epsilon边表：第i条边为m_NFAEpsFrom[i]→m_NFAEpsTo[i]，
+    QList<int> m_NFAEpsTo;  //冻结后m_NFAEpsTo按起点排列，状态s的epsilon目标为[m_NFAEpsOff[s],m_NFAEpsOff[s+1])
+    QList<int> m_NFAEpsOff;//CSR行偏移，长度为NFA状态数+1；为空表示尚未冻结
+    QList<DFANode> m_DFAStateArr;//DFA状态数组
+    QList<mDFANode> m_mDFANodeArr;//mDFA状态数组
+    QList<StateSet> m_NFAClosureArr;//各NFA状态epsilon闭包的缓存，子集构造时按需求出
+
+    //followpos构造：位置即操作符在正则表达式中的每次出现，各规则末尾另有一个结束标记位置，
+    //DFA状态为位置集合，接受其中结束标记所属的规则
+    QList<int> m_posSymbol;//位置→操作符编号，结束标记为-1
+    QList<StateSet> m_followpos;//位置→followpos集合
+    QList<int> m_ruleEndPos;//规则号→其结束标记位置
+    StateSet m_startPos;//DFA初态：各规则firstpos之并
+
+    //稠密转换表：第s行第c列为状态s经字符类c到达的状态号，-1表示无此边（死状态）
+    QList<int> m_DFATrans;//DFA转换表，m_DFAStateNum×m_classNum
+    QList<int> m_mDFATrans;//mDFA转换表，m_mDFAStateNum×m_classNum
 
     NFAGraph m_NFAG;//NFA图
     //DFAGraph DFAG;//NFA转换得的DFA图
     mDFAGraph m_mDFAG;//最小化的DFA图
 
+    PhaseStats m_phaseStats;//各阶段统计信息
+    MinimizeEngine m_minimizeEngine=HopcroftMinimize;//DFA最小化算法
+    LexerBackend m_lexerBackend=SwitchBackend;//词法分析程序生成方式
+    ConstructEngine m_constructEngine=ThompsonConstruct;//DFA构造方式
+    int m_determinizeThreads=1;//子集构造的工作线程数
+    ProgressHandler m_progressHandler;//转换进度回调
+    const QAtomicInt *m_cancelFlag=nullptr;//中止标志，由调用方持有
+    static const int ProgressInterval=256;//每展开/处理这么多个状态（分割集）检查一次进度与中止
+    static const int RepeatLimit=1000;//计数重复{m,n}中m、n的上限
+    static const int PostfixLimit=1000000;//一条正则表达式展开后的后缀式记号数上限
+    QString m_errorStr;//reg2NFA/rules2NFA失败的原因
+
     int m_NFAStateNum;//NFA状态下标计数（从0开始）
     int m_DFAStateNum;//DFA状态下标计数（从0开始）
     int m_mDFAStateNum;//mDFA状态数量计数，亦是划分出来的集合数（从1开始）
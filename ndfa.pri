@@ -0,0 +1,20 @@
+# NFA/DFA转换核心，仅依赖QtCore，供图形界面与命令行工具共用
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+SOURCES += \
+    $$PWD/lazydfa.cpp \
+    $$PWD/lexarena.cpp \
+    $$PWD/lexcache.cpp \
+    $$PWD/leximage.cpp \
+    $$PWD/lexscanner.cpp \
+    $$PWD/ndfa.cpp
+
+HEADERS += \
+    $$PWD/lazydfa.h \
+    $$PWD/lexarena.h \
+    $$PWD/lexcache.h \
+    $$PWD/leximage.h \
+    $$PWD/lexscanner.h \
+    $$PWD/ndfa.h \
+    $$PWD/stateset.h
@@ -0,0 +1,115 @@
+/****************************************************
+ * @Copyright © 2021-2023 Lyuyk. All rights reserved.
+ *
+ * @FileName: ndfaworker.cpp
+ * @Brief: 转换工作线程源文件
+ * @Module Function: 任务参数在主线程中设置后启动线程；转换过程中NDFA的进度回调
+ *                   在工作线程中发出信号，跨线程以排队方式送达主窗体
+ *
+ * @Current Version: 1.0
+ * @Author: Lyuyk
+ * @Modifier: Lyuyk
+ * @Finished Date: 2026/10/16
+ *
+ * @Version History: 1.0 current version
+ *
+ ****************************************************/
+#include "ndfaworker.h"
+
+NDFAWorker::NDFAWorker(NDFA *ndfa, QObject *parent)
+    : QThread(parent)
+    , m_ndfa(ndfa)
+    , m_task(NFATask)
+    , m_ruleMode(false)
+    , m_completed(false)
+{
+    m_ndfa->setCancelFlag(&m_cancelFlag);
+    m_ndfa->setProgressHandler([this](NDFA::Phase phase, int count){
+        if(m_progressTimer.elapsed()>=ProgressIntervalMs)
+        {
+            m_progressTimer.restart();
+            emit progress(phase, count);
+        }
+    });
+}
+
+NDFAWorker::~NDFAWorker()
+{
+    cancel();
+    wait();
+}
+
+void NDFAWorker::startRegex(const QString &regexStr)
+{
+    m_task=NFATask;
+    m_ruleMode=false;
+    m_regexStr=regexStr;
+    m_cancelFlag.storeRelaxed(0);
+    start();
+}
+
+void NDFAWorker::startRules(const QList<NDFA::LexRule> &rules)
+{
+    m_task=NFATask;
+    m_ruleMode=true;
+    m_rules=rules;
+    m_cancelFlag.storeRelaxed(0);
+    start();
+}
+
+void NDFAWorker::startTask(Task task)
+{
+    m_task=task;
+    m_cancelFlag.storeRelaxed(0);
+    start();
+}
+
+/**
+ * @brief NDFAWorker::cancel
+ * 只置中止标志，转换循环在下一个检查点返回，线程随即结束
+ */
+void NDFAWorker::cancel()
+{
+    m_cancelFlag.storeRelaxed(1);
+}
+
+NDFAWorker::Task NDFAWorker::task() const
+{
+    return m_task;
+}
+
+bool NDFAWorker::isRuleMode() const
+{
+    return m_ruleMode;
+}
+
+bool NDFAWorker::isCompleted() const
+{
+    return m_completed;
+}
+
+/**
+ * @brief NDFAWorker::run
+ * 在工作线程中执行当前任务；运行期间主线程不得访问NDFA对象
+ */
+void NDFAWorker::run()
+{
+    m_progressTimer.start();
+    bool completed=true;//NFA构造与展开后的正则表达式长度成线性（长度有上限），不设中止点
+    switch(m_task)
+    {
+    case NFATask:
+        if(m_ruleMode)
+            completed=m_ndfa->rules2NFA(m_rules);
+        else
+            completed=m_ndfa->reg2NFA(m_regexStr);
+        break;
+    case DFATask:
+        completed=m_ndfa->NFA2DFA();
+        break;
+    case mDFATask:
+        completed=m_ndfa->DFA2mDFA();
+        break;
+    }
+    m_completed=completed;
+}
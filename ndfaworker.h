@@ -0,0 +1,70 @@
+/****************************************************
+ * @Copyright © 2021-2023 Lyuyk. All rights reserved.
+ *
+ * @FileName: ndfaworker.h
+ * @Brief: 转换工作线程头文件
+ * @Module Function: 在独立线程中执行正则表达式→NFA、NFA→DFA、DFA最小化，
+ *                   以信号向主窗体报告进度与结果，并可随时请求中止，转换期间界面保持响应
+ *
+ * @Current Version: 1.0
+ * @Author: Lyuyk
+ * @Modifier: Lyuyk
+ * @Finished Date: 2026/10/16
+ *
+ * @Version History: 1.0 current version
+ *
+ ****************************************************/
+#ifndef NDFAWORKER_H
+#define NDFAWORKER_H
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QThread>
+
+#include "ndfa.h"
+
+class NDFAWorker : public QThread
+{
+    Q_OBJECT
+
+public:
+    //转换任务
+    enum Task
+    {
+        NFATask,//reg2NFA / rules2NFA
+        DFATask,//NFA2DFA
+        mDFATask//DFA2mDFA
+    };
+
+public:
+    explicit NDFAWorker(NDFA *ndfa, QObject *parent = nullptr);
+    ~NDFAWorker();
+
+    void startRegex(const QString &regexStr);//单条正则表达式转换为NFA
+    void startRules(const QList<NDFA::LexRule> &rules);//多条词法规则转换为NFA
+    void startTask(Task task);//DFATask或mDFATask
+    void cancel();//请求中止当前转换（主线程调用）
+    Task task() const;
+    bool isRuleMode() const;//NFATask是否按多规则转换
+    bool isCompleted() const;//最近一次任务是否完成（false表示被中止，NFATask时为正则表达式有误），在finished信号后读取
+
+signals:
+    void progress(int phase, int count);//转换进度，phase为NDFA::Phase；结束时发出QThread::finished
+
+protected:
+    void run() override;
+
+private:
+    static const int ProgressIntervalMs=200;//进度信号的最短间隔，避免刷屏
+
+    NDFA *m_ndfa;
+    Task m_task;
+    QString m_regexStr;
+    QList<NDFA::LexRule> m_rules;
+    bool m_ruleMode;//NFATask时是否按多规则转换
+    bool m_completed;
+    QAtomicInt m_cancelFlag;
+    QElapsedTimer m_progressTimer;//只在工作线程中使用
+};
+
+#endif // NDFAWORKER_H
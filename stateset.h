@@ -0,0 +1,160 @@
+/****************************************************
+ * @Copyright © 2021-2023 Lyuyk. All rights reserved.
+ *
+ * @FileName: stateset.h
+ * @Brief: NFA状态集合（位图）头文件
+ * @Module Function: 子集构造中DFA节点所含NFA状态号集合的稠密位图表示，
+ *                   以64位字为单位并行完成并集、比较与哈希；
+ *                   位图可从编译内存池（LexArena）分配，复制与赋值得到的集合使用源集合的内存池
+ *
+ * @Current Version: 1.0
+ * @Author: Lyuyk
+ * @Modifier: Lyuyk
+ * @Finished Date: 2026/10/16
+ *
+ * @Version History: 1.0 current version
+ *
+ ****************************************************/
+#ifndef STATESET_H
+#define STATESET_H
+
+#include<QHash>
+#include<QList>
+#include<QtAlgorithms>
+#include<QtGlobal>
+
+#include "lexarena.h"
+
+class StateSet
+{
+public:
+    //按位遍历集合中的状态号，使 for(int s: set) 与QSet<int>用法一致
+    class const_iterator
+    {
+    public:
+        const_iterator(const StateSet *set, int bit) : m_set(set), m_bit(bit) {}
+        int operator*() const { return m_bit; }
+        const_iterator &operator++() { m_bit=m_set->nextState(m_bit+1); return *this; }
+        bool operator==(const const_iterator &o) const { return m_bit==o.m_bit; }
+        bool operator!=(const const_iterator &o) const { return m_bit!=o.m_bit; }
+
+    private:
+        const StateSet *m_set;
+        int m_bit;
+    };
+
+public:
+    StateSet() {}
+    explicit StateSet(int stateNum, std::pmr::memory_resource *resource=nullptr)
+        : m_words(ArenaAllocator<quint64>(resource)) { m_words.reserve((stateNum+63)/64); }
+
+    void insert(int state)
+    {
+        size_t w=state>>6;
+        if(w>=m_words.size())
+            m_words.resize(w+1, 0);
+        m_words[w]|=quint64(1)<<(state&63);
+    }
+
+    bool contains(int state) const
+    {
+        size_t w=state>>6;
+        return w<m_words.size() && (m_words[w]>>(state&63)&1);
+    }
+
+    //并集，逐字按位或
+    StateSet &unite(const StateSet &other)
+    {
+        if(other.m_words.size()>m_words.size())
+            m_words.resize(other.m_words.size(), 0);
+        const quint64 *src=other.m_words.data();
+        quint64 *dst=m_words.data();
+        for(size_t i=0;i<other.m_words.size();i++)
+            dst[i]|=src[i];
+        return *this;
+    }
+    StateSet &operator|=(const StateSet &other) { return unite(other); }
+
+    bool isEmpty() const
+    {
+        for(const auto &w: m_words)
+            if(w) return false;
+        return true;
+    }
+    bool empty() const { return isEmpty(); }
+
+    int count() const
+    {
+        int n=0;
+        for(const auto &w: m_words)
+            n+=qPopulationCount(w);
+        return n;
+    }
+    int size() const { return count(); }
+
+    void clear() { m_words.clear(); }//保留容量，工作区集合反复使用时不再分配
+
+    //从state开始（含）的下一个状态号，不存在时返回-1
+    int nextState(int state) const
+    {
+        size_t w=state>>6;
+        if(w>=m_words.size())
+            return -1;
+        quint64 bits=m_words[w]&(~quint64(0)<<(state&63));
+        while(!bits)
+        {
+            if(++w>=m_words.size())
+                return -1;
+            bits=m_words[w];
+        }
+        return int(w*64+qCountTrailingZeroBits(bits));
+    }
+
+    const_iterator begin() const { return const_iterator(this, nextState(0)); }
+    const_iterator end() const { return const_iterator(this, -1); }
+
+    QList<int> values() const
+    {
+        QList<int> list;
+        for(int s: *this)
+            list.append(s);
+        return list;
+    }
+
+    //末尾全零的字不参与比较与哈希，容量不同的集合也能正确比较
+    bool operator==(const StateSet &other) const
+    {
+        qsizetype n=usedWords();
+        if(n!=other.usedWords())
+            return false;
+        for(qsizetype i=0;i<n;i++)
+            if(m_words[i]!=other.m_words[i])
+                return false;
+        return true;
+    }
+    bool operator!=(const StateSet &other) const { return !(*this==other); }
+
+    size_t hash(size_t seed) const
+    {
+        return qHashBits(m_words.data(), usedWords()*sizeof(quint64), seed);
+    }
+
+private:
+    qsizetype usedWords() const
+    {
+        qsizetype n=qsizetype(m_words.size());
+        while(n>0 && !m_words[n-1])
+            n--;
+        return n;
+    }
+
+private:
+    ArenaVector<quint64> m_words;//位图，第i位表示状态号i
+};
+
+inline size_t qHash(const StateSet &set, size_t seed=0)
+{
+    return set.hash(seed);
+}
+
+#endif // STATESET_H